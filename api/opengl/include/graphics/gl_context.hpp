@@ -29,12 +29,39 @@ namespace ignis {
 		//VAOs; because they aren't shared (by object id)
 
 		HashMap<GPUObjectId, GLuint> vaos;
+		HashMap<GPUObjectId, List<u64>> vaoRegions;		//Bound region offsets of DYNAMIC vertex buffers
+
+		//Buffers that got new storage and have to be rebound
+
+		List<GPUObjectId> resizedBuffers;
+
+		//Framebuffers of texture subresources (by object id and mip * layers + layer); created on first use
+		//Framebuffers of deleted textures are detached and reused by other textures
+
+		HashMap<GPUObjectId, HashMap<u32, GLuint>> textureFramebuffers;
+		List<GLuint> framebufferPool;
 
 		//Constants that aren't intermediate states
 
 		HashMap<GLenum, GPUObjectId> boundObjects;
 		HashMap<u64, BoundRange> boundByBaseId;	//GLenum lower 32-bit, Base upper 32-bit
 
+		//Buffer readbacks that complete with the execution
+
+		struct Readback {
+
+			void *instance{};
+			cmd::ReadbackBuffer::Callback callback{};
+
+			GPUBuffer *buffer{};
+			UploadBuffer *uploadBuffer{};
+
+			Pair<u64, u64> allocation{};
+			u64 offset{}, size{};
+		};
+
+		List<Readback> readbacks;
+
 		struct Execution {
 
 			GLsync sync{};
@@ -52,9 +79,19 @@ namespace ignis {
 			u8 mip{};
 			bool isStencil{};
 
+			List<Readback> readbacks;
+
 			inline void call() const {
+
 				if (auto func = functionPtr)
 					func(callbackObject, cpuOutput, allocation, gpuTexture, offset, size, layer, mip, isStencil);
+
+				for (auto &readback : readbacks)
+					readback.callback(
+						readback.instance, readback.buffer,
+						readback.uploadBuffer->readbackView(readback.allocation, readback.size),
+						readback.offset, readback.size
+					);
 			}
 
 		};
@@ -85,6 +122,9 @@ namespace ignis {
 
 		u64 frameId{}, executionId{};
 
+		//Execution of the last executed command; equal to executionId once a command ran in the current execution
+		u64 commandExecutionId{};
+
 	};
 
 }
\ No newline at end of file
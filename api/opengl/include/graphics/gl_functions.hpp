@@ -34,6 +34,7 @@ GL_FUNC(glNamedBufferSubData, GLNAMEDBUFFERSUBDATA);
 GL_FUNC(glClearNamedBufferSubData, GLCLEARNAMEDBUFFERSUBDATA);
 GL_FUNC(glBindBuffer, GLBINDBUFFER);
 GL_FUNC(glCopyNamedBufferSubData, GLCOPYNAMEDBUFFERSUBDATA);
+GL_FUNC(glMemoryBarrier, GLMEMORYBARRIER);
 
 //VAOs
 
@@ -85,9 +86,20 @@ GL_FUNC(glTextureStorage3D, GLTEXTURESTORAGE3D);
 GL_FUNC(glTextureSubImage1D, GLTEXTURESUBIMAGE1D);
 GL_FUNC(glTextureSubImage2D, GLTEXTURESUBIMAGE2D);
 GL_FUNC(glTextureSubImage3D, GLTEXTURESUBIMAGE3D);
+GL_FUNC(glCompressedTextureSubImage2D, GLCOMPRESSEDTEXTURESUBIMAGE2D);
+GL_FUNC(glCompressedTextureSubImage3D, GLCOMPRESSEDTEXTURESUBIMAGE3D);
 GL_FUNC(glBindTextureUnit, GLBINDTEXTUREUNIT);
 GL_FUNC(glBindImageTexture, GLBINDIMAGETEXTURE);
 GL_FUNC(glTextureView, GLTEXTUREVIEW);
+GL_FUNC(glClearTexSubImage, GLCLEARTEXSUBIMAGE);
+GL_FUNC(glTextureParameteri, GLTEXTUREPARAMETERI);
+GL_FUNC(glInvalidateTexImage, GLINVALIDATETEXIMAGE);
+GL_FUNC(glGenerateTextureMipmap, GLGENERATETEXTUREMIPMAP);
+GL_FUNC(glCreateShaderProgramv, GLCREATESHADERPROGRAMV);
+GL_FUNC(glProgramUniform1i, GLPROGRAMUNIFORM1I);
+GL_FUNC(glProgramUniform2f, GLPROGRAMUNIFORM2F);
+GL_FUNC(glProgramUniform2ui, GLPROGRAMUNIFORM2UI);
+GL_FUNC(glProgramUniform4fv, GLPROGRAMUNIFORM4FV);
 GL_FUNC(glGetTextureSubImage, GLGETTEXTURESUBIMAGE);
 
 //GPU commands
@@ -79,6 +79,10 @@ namespace ignis {
 		HashMap<usz, GLContext*> contexts;
 		HashMap<PrimitiveBuffer*, bool> primitiveBuffers;
 
+		//Internal compute programs (mip generation and YUV conversion) by key; shared between contexts
+
+		HashMap<u32, GLuint> programs;
+
 		void updateContext(Graphics &g);
 		void destroyContext();
 
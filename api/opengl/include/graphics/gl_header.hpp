@@ -24,6 +24,8 @@ namespace ignis {
 	enum class StencilOp : u8;
 
 	class Descriptors;
+	class TextureObject;
+	struct GPUSubresource;
 	class Pipeline;
 	class PrimitiveBuffer;
 
@@ -61,9 +63,13 @@ extern void APIENTRY glxDebugMessage(
 
 extern void glxBindPipeline(ignis::GLContext &data, ignis::Pipeline *pipeline);
 extern void glxBindDescriptors(ignis::GLContext &data, const List<ignis::Descriptors*> &descriptors);
+extern GLuint glxTextureView(ignis::TextureObject *tex, const ignis::GPUSubresource &subresource, u32 &generation);
 extern bool glxCheckShaderLog(GLuint shader, String &str);
 extern bool glxCheckProgramLog(GLuint program, String &str);
 
 //Per context objects
 
-extern GLuint glxGenerateVao(ignis::PrimitiveBuffer *prim);
\ No newline at end of file
+extern GLuint glxGenerateVao(ignis::PrimitiveBuffer *prim);
+extern void glxUpdateVaoRegions(ignis::GLContext &ctx, GLuint vao, ignis::PrimitiveBuffer *prim);
+extern GLuint glxTextureFramebuffer(ignis::GLContext &ctx, ignis::TextureObject *tex, u16 layer, u8 mip);
+extern void glxReleaseTextureFramebuffers(ignis::GLContext &ctx, const ignis::GPUObjectId &tex);
\ No newline at end of file
@@ -5,7 +5,18 @@
 namespace ignis {
 
 	struct GPUBuffer::Data {
+
 		volatile u8 *unmapped{};
 		GLuint handle{};
+
+		u32 generation{};		//Increased every time the handle changes
+
+		//DYNAMIC ring; each region is regionSize and the last execution that could read it
+
+		List<u64> regionExecutionIds;
+		u64 regionSize{};
+		u64 flushExecution = u64_MAX;	//Last execution that published a region
+
+		u8 region{}, writeRegion{};
 	};
 }
\ No newline at end of file
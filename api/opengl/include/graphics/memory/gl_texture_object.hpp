@@ -9,11 +9,41 @@ namespace ignis {
 
 		GLuint handle{};
 
-		List<GLuint> framebuffer;		//Only if it's GPU_WRITABLE
+		//Subresources by viewKey(range); created when descriptors are flushed
+		HashMap<u64, GLuint> textureViews;
 
-		//Subresources
-		List<std::pair<GPUSubresource::TextureRange, GLuint>> textureViews;
+		//Incremented when the views are destroyed (resize), so descriptors resolve them again
+		u32 viewGeneration{};
 
+		//Lowest mip that is sampled (streaming textures); views are clamped relative to their first level
+		u8 baseLevel{};
+
+		//Levels are < 256 and layers are u16, so the range fits in 64 bits
+		static inline u64 viewKey(const GPUSubresource::TextureRange &range) {
+			return
+				u64(u8(range.minLevel)) | (u64(u8(range.levelCount)) << 8) |
+				(u64(u16(range.minLayer)) << 16) | (u64(u16(range.layerCount)) << 32) |
+				(u64(range.subType) << 48);
+		}
+
+		static inline GLint viewBaseLevel(u64 key, u8 baseLevel) {
+			u8 minLevel = u8(key), levelCount = u8(key >> 8);
+			return GLint(baseLevel <= minLevel ? 0 : std::min(u8(baseLevel - minLevel), u8(levelCount - 1)));
+		}
 	};
 
-}
\ No newline at end of file
+	//Upload into a region of a mip; src is an offset if a pixel unpack buffer is bound
+
+	void glxTextureSubImage(
+		GLuint handle, TextureType textureType, u8 mip, 
+		const Vec3u16 &start, const Vec3u16 &size, 
+		GLenum format, GLenum type, const void *src
+	);
+
+	void glxCompressedTextureSubImage(
+		GLuint handle, TextureType textureType, u8 mip, 
+		const Vec3u16 &start, const Vec3u16 &size, 
+		GLenum format, GLsizei imageSize, const void *src
+	);
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "graphics/shader/descriptors.hpp"
+#include "graphics/gl_graphics.hpp"
+
+namespace ignis {
+
+	struct Descriptors::Data {
+
+		//A flushed resource resolved for binding; the register, resource type and texture view are looked up once
+		struct Binding {
+
+			const RegisterLayout *layout;
+			GPUSubresource subresource;
+
+			GPUBuffer *buffer{};
+			Sampler *sampler{};
+			TextureObject *texture{};
+
+			GLuint textureView{};
+			u32 viewGeneration{};
+		};
+
+		//In the order of the pipeline layout
+		List<Binding> bindings;
+	};
+
+}
@@ -6,6 +6,7 @@
 #include "graphics/memory/gl_framebuffer.hpp"
 #include "graphics/memory/gl_gpu_buffer.hpp"
 #include "graphics/memory/gl_texture_object.hpp"
+#include "graphics/memory/video_texture.hpp"
 #include "graphics/shader/descriptors.hpp"
 #include "graphics/shader/pipeline.hpp"
 #include "graphics/gl_context.hpp"
@@ -53,8 +54,12 @@ namespace ignis {
 
 		//Execute commands
 
-		for (Command *c : info.commands)
+		GLContext &ctx = getGraphics().getData()->getContext();
+
+		for (Command *c : info.commands) {
 			c->execute(getGraphics(), data);
+			ctx.commandExecutionId = ctx.executionId;
+		}
 
 	}
 
@@ -158,6 +163,11 @@ namespace ignis {
 			glBindVertexArray(ctx.vaos[id]);
 		}
 
+		//DYNAMIC vertex buffers move to another region every flush
+
+		if (primitiveBuffer)
+			glxUpdateVaoRegions(ctx, ctx.vaos[primitiveBuffer->getId()], primitiveBuffer);
+
 		//Bind & validate framebuffer
 
 		auto *framebuffer = ctx.bound.framebuffer;
@@ -291,7 +301,8 @@ namespace ignis {
 				glxGpuFormatType(ctx.bound.primitiveBuffer->getIndexFormat()),
 				(void*)(
 					usz(start) * 
-					FormatHelper::getSizeBytes(ctx.bound.primitiveBuffer->getIndexFormat())
+					FormatHelper::getSizeBytes(ctx.bound.primitiveBuffer->getIndexFormat()) +
+					ctx.bound.primitiveBuffer->getIndexBuffer().buffer->getRegionOffset()
 				),
 				instanceCount,
 				vertexStart,
@@ -360,7 +371,7 @@ namespace ignis {
 			ctx.boundObjects[GL_DISPATCH_INDIRECT_BUFFER] = buf->getId();
 		}
 
-		glDispatchComputeIndirect(GLintptr(offset));
+		glDispatchComputeIndirect(GLintptr(offset + buf->getRegionOffset()));
 	}
 
 	//Clearing
@@ -437,18 +448,750 @@ namespace ignis {
 
 		auto &ctx = context;
 
-		glxSetViewport(ctx, siz.cast<Vec2u32>(), offset.cast<Vec2i32>());
+		//The active scissor limits the cleared region, like it limits draws (it's only active if it differs from the viewport)
 
-		if (ctx.enableScissor) {
-			glDisable(GL_SCISSOR_TEST);
-			ctx.enableScissor = false;
+		Vec2i32 clearStart = offset.cast<Vec2i32>().max(Vec2i32{});
+		Vec2i32 clearEnd = offset.cast<Vec2i32>() + siz.cast<Vec2i32>();
+
+		const cmd::SetScissor &scissor = ctx.bound.scissor;
+		const cmd::SetViewport &viewport = ctx.bound.viewport;
+
+		if (scissor.dim.all() && (scissor.dim != viewport.dim || scissor.offset != viewport.offset)) {
+			clearStart = clearStart.max(scissor.offset);
+			clearEnd = clearEnd.min(scissor.offset + scissor.dim.cast<Vec2i32>());
 		}
 
-		for(u16 l = slice; l < slice + slices; ++l)
-			for(u16 m = mipLevels; m < mipLevel + mipLevels; ++m)
-				glxClearFramebuffer(
-					ctx, texture->getData()->framebuffer[size_t(l) * texture->getInfo().mips + m], 0, ctx.clearColor
+		if (!(clearEnd > clearStart).all())
+			return;
+
+		//Every texel of a mip that covers the region is cleared
+
+		auto &info = texture->getInfo();
+
+		auto mipRegion = [&](u16 m, Vec2u32 &start, Vec2u32 &end) {
+			Vec2u32 mipSize = info.mipSizes[m].xy().cast<Vec2u32>();
+			start = (clearStart.cast<Vec2u32>() / (1u << m)).min(mipSize);
+			end = ((clearEnd.cast<Vec2u32>() - Vec2u32(1, 1)) / (1u << m) + Vec2u32(1, 1)).min(mipSize);
+		};
+
+		//Clear without a framebuffer if it's supported (GL 4.4 or ARB_clear_texture)
+
+		if (glClearTexSubImage) {
+
+			bool isFloat = ctx.clearColor.type == SetClearColor::Type::FLOAT;
+			bool isUint = ctx.clearColor.type == SetClearColor::Type::UNSIGNED_INT;
+
+			GLenum format = isFloat ? GL_RGBA : GL_RGBA_INTEGER;
+			GLenum type = isFloat ? GL_FLOAT : (isUint ? GL_UNSIGNED_INT : GL_INT);
+
+			const void *color = isFloat ? (const void*) ctx.clearColor.rgbaf.arr : (
+				isUint ? (const void*) ctx.clearColor.rgbau.arr : (const void*) ctx.clearColor.rgbai.arr
+			);
+
+			//Layers of 1D arrays are stored in y
+
+			bool is1DArray = info.textureType == TextureType::TEXTURE_1D_ARRAY;
+
+			for (u16 m = mipLevel; m < mipLevel + mipLevels; ++m) {
+
+				Vec2u32 start, end;
+				mipRegion(m, start, end);
+
+				glClearTexSubImage(
+					texture->getData()->handle, m,
+					start.x, is1DArray ? slice : start.y, is1DArray ? 0 : slice,
+					end.x - start.x, is1DArray ? slices : end.y - start.y, is1DArray ? 1 : slices,
+					format, type, color
 				);
+			}
+
+			return;
+		}
+
+		//Framebuffer clears are limited by the scissor test
+
+		if (!ctx.enableScissor) {
+			glEnable(GL_SCISSOR_TEST);
+			ctx.enableScissor = true;
+		}
+
+		for(u16 m = mipLevel; m < mipLevel + mipLevels; ++m) {
+
+			Vec2u32 start, end;
+			mipRegion(m, start, end);
+
+			glxSetViewport(ctx, end - start, start.cast<Vec2i32>());
+
+			ctx.boundApi.scissor.dim = end - start;
+			ctx.boundApi.scissor.offset = start.cast<Vec2i32>();
+			glScissor(GLint(start.x), GLint(start.y), GLsizei(end.x - start.x), GLsizei(end.y - start.y));
+
+			for(u16 l = slice; l < slice + slices; ++l)
+				glxClearFramebuffer(ctx, glxTextureFramebuffer(ctx, texture, l, u8(m)), 0, ctx.clearColor);
+		}
+	}
+
+	//Internal compute shaders
+
+	//Units used by internal programs are bound outside of the bound state; they're rebound by the next dispatch or draw
+
+	static void glxResetInternalState(GLContext &ctx, u32 textureUnits, u32 imageUnits, u32 storageBuffers) {
+
+		ctx.boundApi.pipeline = nullptr;
+
+		for (u32 i = 0; i < textureUnits; ++i)
+			ctx.boundByBaseId.erase((u64(i) << 32) | GL_TEXTURE);
+
+		for (u32 i = 0; i < imageUnits; ++i)
+			ctx.boundByBaseId.erase((u64(i) << 32) | GL_IMAGE_2D);
+
+		for (u32 i = 0; i < storageBuffers; ++i)
+			ctx.boundByBaseId.erase((u64(i) << 32) | GL_SHADER_STORAGE_BUFFER);
+	}
+
+	//Image format qualifiers of the formats that can be downsampled by the compute shader
+
+	static const char *glxImageFormat(GPUFormat format) {
+
+		switch (format.value) {
+
+			case GPUFormat::r8:			return "r8";
+			case GPUFormat::rg8:		return "rg8";
+			case GPUFormat::rgba8:		return "rgba8";
+			case GPUFormat::r16:		return "r16";
+			case GPUFormat::rg16:		return "rg16";
+			case GPUFormat::rgba16:		return "rgba16";
+
+			case GPUFormat::r8s:		return "r8_snorm";
+			case GPUFormat::rg8s:		return "rg8_snorm";
+			case GPUFormat::rgba8s:		return "rgba8_snorm";
+			case GPUFormat::r16s:		return "r16_snorm";
+			case GPUFormat::rg16s:		return "rg16_snorm";
+			case GPUFormat::rgba16s:	return "rgba16_snorm";
+
+			case GPUFormat::r16f:		return "r16f";
+			case GPUFormat::rg16f:		return "rg16f";
+			case GPUFormat::rgba16f:	return "rgba16f";
+			case GPUFormat::r32f:		return "r32f";
+			case GPUFormat::rg32f:		return "rg32f";
+			case GPUFormat::rgba32f:	return "rgba32f";
+
+			case GPUFormat::rgb10a2:	return "rgb10_a2";
+			case GPUFormat::r11g11b10f:	return "r11f_g11f_b10f";
+
+			default:					return nullptr;
+		}
+	}
+
+	//Mips are written 2D arrays (cubes are viewed as one); one work group per 16x16 texels of the first written mip.
+	//BOX averages 2x2 texels and writes up to 5 mips, the next mips are reduced in shared memory.
+	//The other filters are the kernels of Texture::Info::generateMips and write a single mip
+
+	static constexpr u32 glxMipsPerDispatch = 5;
+
+	static constexpr const char *glxMipBoxShader = R"(
+		layout(local_size_x = 16, local_size_y = 16) in;
+
+		layout(binding = 0, FORMAT) uniform readonly image2DArray src;
+		layout(binding = 1, FORMAT) uniform writeonly image2DArray dst[5];
+
+		layout(location = 0) uniform int mipCount;
+
+		shared vec4 tile[16][16];
+
+		void main() {
+
+			ivec2 p = ivec2(gl_GlobalInvocationID.xy), l = ivec2(gl_LocalInvocationID.xy);
+			int layer = int(gl_GlobalInvocationID.z);
+
+			ivec2 srcMax = imageSize(src).xy - 1;
+
+			vec4 c = (
+				imageLoad(src, ivec3(min(p * 2, srcMax), layer)) +
+				imageLoad(src, ivec3(min(p * 2 + ivec2(1, 0), srcMax), layer)) +
+				imageLoad(src, ivec3(min(p * 2 + ivec2(0, 1), srcMax), layer)) +
+				imageLoad(src, ivec3(min(p * 2 + ivec2(1, 1), srcMax), layer))
+			) * .25;
+
+			if (all(lessThan(p, imageSize(dst[0]).xy)))
+				imageStore(dst[0], ivec3(p, layer), c);
+
+			tile[l.y][l.x] = c;
+
+			//Every level, a quarter of the threads averages the texels of the previous level
+
+			for (int i = 1; i < 5; ++i) {
+
+				barrier();
+
+				if (i >= mipCount)
+					break;
+
+				int step = 1 << i, half = step >> 1;
+
+				if (all(equal(l & (step - 1), ivec2(0)))) {
+
+					c = (tile[l.y][l.x] + tile[l.y][l.x + half] + tile[l.y + half][l.x] + tile[l.y + half][l.x + half]) * .25;
+					tile[l.y][l.x] = c;
+
+					ivec2 q = ivec2(gl_WorkGroupID.xy) * (16 >> i) + (l >> i);
+
+					if (all(lessThan(q, imageSize(dst[i]).xy)))
+						imageStore(dst[i], ivec3(q, layer), c);
+				}
+			}
+		}
+	)";
+
+	static constexpr const char *glxMipFilterShader = R"(
+		layout(local_size_x = 16, local_size_y = 16) in;
+
+		layout(binding = 0, FORMAT) uniform readonly image2DArray src;
+		layout(binding = 1, FORMAT) uniform writeonly image2DArray dst;
+
+		const float pi = 3.14159265358979323846, kaiserAlpha = 4.0, kaiserRadius = 3.0;
+
+		float besselI0(float x) {
+
+			float sum = 1.0, term = 1.0;
+
+			for (int k = 1; k < 16; ++k) {
+				float t = x / float(2 * k);
+				term *= t * t;
+				sum += term;
+			}
+
+			return sum;
+		}
+
+		float weight(float x) {
+
+			x = abs(x);
+
+			#if FILTER == 1
+				return max(1.0 - x, 0.0);
+			#else
+
+				if (x >= kaiserRadius)
+					return 0.0;
+
+				float sinc = x < 1e-6 ? 1.0 : sin(pi * x) / (pi * x);
+				float r = x / kaiserRadius;
+
+				return sinc * besselI0(kaiserAlpha * sqrt(1.0 - r * r)) / besselI0(kaiserAlpha);
+			#endif
+		}
+
+		void main() {
+
+			ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+			int layer = int(gl_GlobalInvocationID.z);
+
+			ivec2 srcSize = imageSize(src).xy, dstSize = imageSize(dst).xy;
+
+			if (any(greaterThanEqual(p, dstSize)))
+				return;
+
+			#if FILTER == 1
+				const float radius = 1.0;
+			#else
+				const float radius = kaiserRadius;
+			#endif
+
+			vec2 scale = vec2(srcSize) / vec2(dstSize);
+			vec2 support = max(scale, vec2(1.0));
+			vec2 center = (vec2(p) + .5) * scale;
+
+			ivec2 lo = ivec2(floor(center - radius * support)), hi = ivec2(ceil(center + radius * support));
+
+			vec4 sum = vec4(0.0);
+			float total = 0.0;
+
+			for (int y = lo.y; y <= hi.y; ++y) {
+
+				float wy = weight((float(y) + .5 - center.y) / support.y);
+
+				if (wy == 0.0)
+					continue;
+
+				for (int x = lo.x; x <= hi.x; ++x) {
+
+					float w = wy * weight((float(x) + .5 - center.x) / support.x);
+
+					if (w == 0.0)
+						continue;
+
+					sum += imageLoad(src, ivec3(clamp(ivec2(x, y), ivec2(0), srcSize - 1), layer)) * w;
+					total += w;
+				}
+			}
+
+			imageStore(dst, ivec3(p, layer), total == 0.0 ? imageLoad(src, ivec3(min(p * 2, srcSize - 1), layer)) : sum / total);
+		}
+	)";
+
+	//Internal compute programs are compiled on first use; key is the kind << 24 | variant
+
+	enum class GLXProgram : u32 {
+		MIPS,
+		CONVERT_YUV,
+		ENCODE_NV12,
+		VIRTUAL_FEEDBACK
+	};
+
+	static GLuint glxProgram(
+		Graphics::Data &data, GLXProgram kind, u32 variant, const String &defines, const char *body, const String &name
+	) {
+
+		auto &program = data.programs[(u32(kind) << 24) | variant];
+
+		if (program)
+			return program;
+
+		String source = "#version 450\n" + defines + body;
+
+		const char *str = source.c_str();
+		program = glCreateShaderProgramv(GL_COMPUTE_SHADER, 1, &str);
+
+		String error;
+
+		if (glxCheckProgramLog(program, error))
+			oic::System::log()->fatal("Couldn't compile internal shader ", name, " ", error);
+
+		glObjectLabel(GL_PROGRAM, program, GLsizei(name.size()), name.c_str());
+		return program;
+	}
+
+	static GLuint glxMipProgram(Graphics::Data &data, MipFilter filter, GPUFormat format) {
+		return glxProgram(
+			data, GLXProgram::MIPS, (u32(filter) << 16) | u32(format.value),
+			"#define FORMAT " + String(glxImageFormat(format)) + "\n"
+			"#define FILTER " + std::to_string(u32(filter)) + "\n",
+			filter == MipFilter::BOX ? glxMipBoxShader : glxMipFilterShader,
+			"Mip generation " + std::to_string(u32(filter)) + " " + std::to_string(u32(format.value))
+		);
+	}
+
+	void GenerateMips::execute(Graphics &g, CommandList::Data*) const {
+
+		if (!texture) {
+			oic::System::log()->error("Generate mips ignored; texture was invalid");
+			return;
+		}
+
+		auto &info = texture->getInfo();
+
+		if (!HasFlags(info.usage, GPUMemoryUsage::GPU_WRITE)) {
+			oic::System::log()->error("Generate mips can only be invoked on GPU writable textures");
+			return;
+		}
+
+		if (info.mips <= 1)
+			return;
+
+		if (FormatHelper::isUnnormalized(info.format)) {
+			oic::System::log()->error("Generate mips isn't supported for integer formats");
+			return;
+		}
+
+		GLuint handle = texture->getData()->handle;
+
+		bool isLayered2D =
+			info.textureType == TextureType::TEXTURE_2D || info.textureType == TextureType::TEXTURE_2D_ARRAY ||
+			info.textureType == TextureType::TEXTURE_CUBE || info.textureType == TextureType::TEXTURE_CUBE_ARRAY;
+
+		//Writes of previous dispatches have to be visible for the driver and the compute shader
+
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		if (!isLayered2D || !glxImageFormat(info.format)) {
+			glGenerateTextureMipmap(handle);
+			return;
+		}
+
+		auto &ctx = context;
+		auto *data = g.getData();
+
+		GLuint program = glxMipProgram(*data, filter, info.format);
+		GLenum format = glxColorFormat(info.format);
+
+		u32 generation{};
+		GLuint view = glxTextureView(texture, GPUSubresource(texture, TextureType::TEXTURE_2D_ARRAY), generation);
+
+		glUseProgram(program);
+
+		u32 perDispatch = filter == MipFilter::BOX ? glxMipsPerDispatch : 1;
+
+		for (u32 m = 0; m + 1 < info.mips; m += perDispatch) {
+
+			u32 mipCount = std::min(perDispatch, info.mips - 1 - m);
+
+			glBindImageTexture(0, view, GLint(m), GL_TRUE, 0, GL_READ_ONLY, format);
+
+			for (u32 i = 0; i < mipCount; ++i)
+				glBindImageTexture(1 + i, view, GLint(m + 1 + i), GL_TRUE, 0, GL_WRITE_ONLY, format);
+
+			if (filter == MipFilter::BOX)
+				glProgramUniform1i(program, 0, GLint(mipCount));
+
+			Vec2u32 dst = info.mipSizes[m + 1].xy().cast<Vec2u32>();
+			glDispatchCompute((dst.x + 15) / 16, (dst.y + 15) / 16, info.layers);
+
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+		}
+
+		//Make the mips visible to sampling, framebuffers and copies
+
+		glMemoryBarrier(
+			GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT | 
+			GL_TEXTURE_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT
+		);
+
+		glxResetInternalState(ctx, 0, 1 + glxMipsPerDispatch, 0);
+	}
+
+	//YUV conversion
+
+	static constexpr const char *glxConvertYUVShader = R"(
+		layout(local_size_x = 16, local_size_y = 16) in;
+
+		layout(binding = 0) uniform sampler2D luma;
+		layout(binding = 1) uniform sampler2D chromaU;
+		layout(binding = 2) uniform sampler2D chromaV;
+
+		layout(binding = 0, FORMAT) uniform writeonly image2D dst;
+
+		layout(location = 0) uniform vec4 rows[3];
+		layout(location = 3) uniform vec2 siting;		//Luma position of the first chroma sample
+
+		vec2 chroma(ivec2 c) {
+
+			#if PLANES == 3
+				return vec2(texelFetch(chromaU, c, 0).r, texelFetch(chromaV, c, 0).r);
+			#else
+				return texelFetch(chromaU, c, 0).rg;
+			#endif
+		}
+
+		void main() {
+
+			ivec2 p = ivec2(gl_GlobalInvocationID.xy), size = imageSize(dst);
+
+			if (any(greaterThanEqual(p, size)))
+				return;
+
+			ivec2 chromaSize = textureSize(chromaU, 0), chromaMax = chromaSize - 1;
+
+			vec2 c = (vec2(p) + siting) * vec2(chromaSize) / vec2(size) - siting;
+			ivec2 c0 = ivec2(floor(c));
+			vec2 f = c - vec2(c0);
+
+			vec2 uv = mix(
+				mix(chroma(clamp(c0, ivec2(0), chromaMax)), chroma(clamp(c0 + ivec2(1, 0), ivec2(0), chromaMax)), f.x),
+				mix(chroma(clamp(c0 + ivec2(0, 1), ivec2(0), chromaMax)), chroma(clamp(c0 + ivec2(1), ivec2(0), chromaMax)), f.x),
+				f.y
+			);
+
+			vec4 yuv = vec4(texelFetch(luma, p, 0).r, uv, 1.0);
+			vec3 rgb = vec3(dot(rows[0], yuv), dot(rows[1], yuv), dot(rows[2], yuv));
+
+			imageStore(dst, p, vec4(clamp(rgb, 0.0, 1.0), 1.0));
+		}
+	)";
+
+	//Every invocation packs 4 luma samples of a row into a word;
+	//invocations of the first half of the rows also pack the two chroma pairs of the 4x2 pixels below them
+
+	static constexpr const char *glxEncodeNV12Shader = R"(
+		layout(local_size_x = 16, local_size_y = 16) in;
+
+		layout(binding = 0) uniform sampler2D src;
+
+		layout(std430, binding = 0) writeonly buffer Frame {
+			uint words[];
+		};
+
+		layout(location = 0) uniform vec4 rows[3];
+		layout(location = 3) uniform int leftSited;
+
+		uint quantize(float v) {
+			return uint(clamp(round(v * 255.0), 0.0, 255.0));
+		}
+
+		//The YUV matrices apply to non linear rgb, but sRGB textures are linearized when fetched
+
+		vec3 fetch(ivec2 q) {
+
+			vec3 c = texelFetch(src, clamp(q, ivec2(0), textureSize(src, 0) - 1), 0).rgb;
+
+			#ifdef SRGB
+				c = mix(c * 12.92, 1.055 * pow(c, vec3(1.0 / 2.4)) - .055, greaterThan(c, vec3(.0031308)));
+			#endif
+
+			return c;
+		}
+
+		void main() {
+
+			ivec2 p = ivec2(gl_GlobalInvocationID.xy), size = textureSize(src, 0);
+			int wordsPerRow = size.x / 4;
+
+			if (p.x >= wordsPerRow || p.y >= size.y)
+				return;
+
+			uint luma = 0u;
+
+			for (int i = 0; i < 4; ++i) {
+				vec4 rgb = vec4(fetch(ivec2(p.x * 4 + i, p.y)), 1.0);
+				luma |= quantize(dot(rows[0], rgb)) << (8 * i);
+			}
+
+			words[p.y * wordsPerRow + p.x] = luma;
+
+			if (p.y >= size.y / 2)
+				return;
+
+			uint chroma = 0u;
+
+			for (int i = 0; i < 2; ++i) {
+
+				ivec2 q = ivec2(p.x * 4 + i * 2, p.y * 2);
+
+				//Left sited chroma is filtered (1, 2, 1) around the even column, center sited chroma is the 2x2 average;
+				//vertically both are between the two rows
+
+				vec3 c;
+
+				if (leftSited != 0)
+					c = (
+						fetch(q + ivec2(-1, 0)) + 2.0 * fetch(q) + fetch(q + ivec2(1, 0)) +
+						fetch(q + ivec2(-1, 1)) + 2.0 * fetch(q + ivec2(0, 1)) + fetch(q + ivec2(1))
+					) * .125;
+
+				else c = (fetch(q) + fetch(q + ivec2(1, 0)) + fetch(q + ivec2(0, 1)) + fetch(q + ivec2(1))) * .25;
+
+				vec4 rgb = vec4(c, 1.0);
+
+				chroma |= (quantize(dot(rows[1], rgb)) | (quantize(dot(rows[2], rgb)) << 8)) << (16 * i);
+			}
+
+			words[(size.y + p.y) * wordsPerRow + p.x] = chroma;
+		}
+	)";
+
+	void ConvertYUV::execute(Graphics &g, CommandList::Data*) const {
+
+		if (!output || !luma || !u) {
+			oic::System::log()->error("Convert YUV ignored; a texture was invalid");
+			return;
+		}
+
+		auto &info = output->getInfo();
+
+		if (!HasFlags(info.usage, GPUMemoryUsage::GPU_WRITE) || !glxImageFormat(info.format)) {
+			oic::System::log()->error("Convert YUV requires a GPU writable output with a float or normalized format");
+			return;
+		}
+
+		if (luma->getInfo().dimensions != info.dimensions) {
+			oic::System::log()->error("Convert YUV requires luma of the same size as the output");
+			return;
+		}
+
+		auto &ctx = context;
+
+		u32 planes = v ? 3 : 2;
+		u8 bits = luma->getInfo().format == GPUFormat::r16 ? 10 : 8;
+
+		GLuint program = glxProgram(
+			*g.getData(), GLXProgram::CONVERT_YUV, (planes << 16) | u32(info.format.value),
+			"#define FORMAT " + String(glxImageFormat(info.format)) + "\n"
+			"#define PLANES " + std::to_string(planes) + "\n",
+			glxConvertYUVShader, "Convert YUV " + std::to_string(planes) + " " + std::to_string(u32(info.format.value))
+		);
+
+		f32 m[12];
+		YUVConversion::toRGB(matrix, range, bits, m);
+		glProgramUniform4fv(program, 0, 3, m);
+
+		glProgramUniform2f(program, 3, siting == YUVChromaSiting::LEFT ? 0.f : .5f, .5f);
+
+		glUseProgram(program);
+
+		glBindTextureUnit(0, luma->getData()->handle);
+		glBindTextureUnit(1, u->getData()->handle);
+
+		if (v)
+			glBindTextureUnit(2, v->getData()->handle);
+
+		glBindImageTexture(0, output->getData()->handle, 0, GL_FALSE, 0, GL_WRITE_ONLY, glxColorFormat(info.format));
+
+		glDispatchCompute((info.dimensions.x + 15) / 16, (info.dimensions.y + 15) / 16, 1);
+
+		glMemoryBarrier(
+			GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
+			GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT
+		);
+
+		glxResetInternalState(ctx, planes, 1, 0);
+	}
+
+	void EncodeNV12::execute(Graphics &g, CommandList::Data*) const {
+
+		if (!input || !output) {
+			oic::System::log()->error("Encode NV12 ignored; texture or buffer was invalid");
+			return;
+		}
+
+		auto &info = input->getInfo();
+		Vec2u32 size = info.dimensions.xy().cast<Vec2u32>();
+
+		if ((size.x & 3) || (size.y & 1)) {
+			oic::System::log()->error("Encode NV12 requires a width that's a multiple of 4 and an even height");
+			return;
+		}
+
+		if (FormatHelper::isUnnormalized(info.format) || FormatHelper::isCompressed(info.format)) {
+			oic::System::log()->error("Encode NV12 requires a float or normalized texture");
+			return;
+		}
+
+		if (!HasFlags(output->getInfo().usage, GPUMemoryUsage::GPU_WRITE)) {
+			oic::System::log()->error("Encode NV12 requires a GPU writable buffer");
+			return;
+		}
+
+		u64 bytes = u64(size.x) * size.y * 3 / 2;
+
+		if (offset + bytes > output->size()) {
+			oic::System::log()->error("Encode NV12 out of bounds");
+			return;
+		}
+
+		auto &ctx = context;
+
+		bool isSRGB = FormatHelper::isSRGB(info.format);
+
+		GLuint program = glxProgram(
+			*g.getData(), GLXProgram::ENCODE_NV12, u32(isSRGB), isSRGB ? "#define SRGB\n" : "",
+			glxEncodeNV12Shader, isSRGB ? "Encode NV12 sRGB" : "Encode NV12"
+		);
+
+		f32 m[12];
+		YUVConversion::toYUV(matrix, range, m);
+		glProgramUniform4fv(program, 0, 3, m);
+		glProgramUniform1i(program, 3, GLint(siting == YUVChromaSiting::LEFT));
+
+		//Writes into the texture by shaders have to be visible
+
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		glUseProgram(program);
+		glBindTextureUnit(0, input->getData()->handle);
+
+		glBindBufferRange(
+			GL_SHADER_STORAGE_BUFFER, 0, output->getExtendedData()->handle,
+			GLintptr(output->getRegionOffset() + offset), GLsizeiptr(bytes)
+		);
+
+		glDispatchCompute((size.x / 4 + 15) / 16, (size.y + 15) / 16, 1);
+
+		//The frame is read by copies (ReadbackBuffer) or shaders
+
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+
+		glxResetInternalState(ctx, 1, 0, 1);
+	}
+
+	//Every invocation marks the page that a texel of the requests needs; uv wraps around
+
+	static constexpr const char *glxVirtualFeedbackShader = R"(
+		layout(local_size_x = 16, local_size_y = 16) in;
+
+		layout(binding = 0) uniform sampler2D requests;
+
+		layout(std430, binding = 0) buffer Feedback {
+			uint feedback[];
+		};
+
+		layout(location = 0) uniform uvec2 pages;
+		layout(location = 1) uniform int mips;
+
+		void main() {
+
+			ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+
+			if (any(greaterThanEqual(p, textureSize(requests, 0))))
+				return;
+
+			vec4 request = texelFetch(requests, p, 0);
+
+			if (request.w <= 0.0)
+				return;
+
+			int mip = clamp(int(request.z), 0, mips - 1);
+			uint page = 0u;
+
+			for (int m = 0; m < mip; ++m) {
+				uvec2 size = max(pages >> m, uvec2(1));
+				page += size.x * size.y;
+			}
+
+			uvec2 size = max(pages >> mip, uvec2(1));
+			uvec2 tile = min(uvec2(fract(request.xy) * vec2(size)), size - 1u);
+
+			page += tile.y * size.x + tile.x;
+			atomicOr(feedback[page >> 5], 1u << (page & 31u));
+		}
+	)";
+
+	void VirtualTextureFeedback::execute(Graphics &g, CommandList::Data*) const {
+
+		if (!requests || !feedback) {
+			oic::System::log()->error("Virtual texture feedback ignored; texture or buffer was invalid");
+			return;
+		}
+
+		auto &info = requests->getInfo();
+
+		if (FormatHelper::isUnnormalized(info.format) || FormatHelper::isCompressed(info.format)) {
+			oic::System::log()->error("Virtual texture feedback requires a float or normalized requests texture");
+			return;
+		}
+
+		if (!HasFlags(feedback->getInfo().usage, GPUMemoryUsage::GPU_WRITE)) {
+			oic::System::log()->error("Virtual texture feedback requires a GPU writable buffer");
+			return;
+		}
+
+		auto &ctx = context;
+
+		GLuint program = glxProgram(
+			*g.getData(), GLXProgram::VIRTUAL_FEEDBACK, 0, "", glxVirtualFeedbackShader, "Virtual texture feedback"
+		);
+
+		glProgramUniform2ui(program, 0, pages.x, pages.y);
+		glProgramUniform1i(program, 1, GLint(mips));
+
+		//Writes into the requests by shaders have to be visible
+
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		glUseProgram(program);
+		glBindTextureUnit(0, requests->getData()->handle);
+
+		glBindBufferRange(
+			GL_SHADER_STORAGE_BUFFER, 0, feedback->getExtendedData()->handle,
+			GLintptr(feedback->getRegionOffset()), GLsizeiptr(feedback->size())
+		);
+
+		glDispatchCompute((info.dimensions.x + 15) / 16, (info.dimensions.y + 15) / 16, 1);
+
+		//The feedback is read by copies (ReadbackBuffer)
+
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+		glxResetInternalState(ctx, 1, 0, 1);
 	}
 
 	void ClearBuffer::execute(Graphics&, CommandList::Data*) const {
@@ -483,12 +1226,133 @@ namespace ignis {
 		glClearNamedBufferSubData(
 			buffer->getExtendedData()->handle,
 			GL_R32UI,
-			offset, size,
+			offset + buffer->getRegionOffset(), size,
 			GL_RED_INTEGER, GL_UNSIGNED_INT,
 			nullptr
 		);
 	}
 
+	//Transfer
+
+	void UploadImage::prepare(Graphics &g, CommandList::Data*) {
+
+		allocation = { 0, u64_MAX };
+		staged.clear();
+
+		if (!image || !uploadBuffer || !queue) {
+			oic::System::log()->error("Upload image requires a texture, upload buffer and queue");
+			return;
+		}
+
+		if (queue->regions.empty())
+			return;
+
+		//The queue is kept if it can't be staged, so it's retried on the next execution
+
+		allocation = uploadBuffer->allocate(context.executionId, queue->data.data(), queue->data.size(), 16);
+
+		if (allocation.second == u64_MAX) {
+			oic::System::log()->error("Upload image couldn't allocate memory in the upload buffer");
+			return;
+		}
+
+		staged = std::move(queue->regions);
+		queue->regions.clear();
+		queue->data.clear();
+	}
+
+	void UploadImage::execute(Graphics&, CommandList::Data*) const {
+
+		if (staged.empty())
+			return;
+
+		auto &buffers = uploadBuffer->getInfo().buffers;
+		auto it = buffers.find(allocation.first);
+
+		if (it == buffers.end()) {
+			oic::System::log()->error("Upload image staging buffer isn't found in the upload buffer");
+			return;
+		}
+
+		auto &info = image->getInfo();
+		GLuint handle = image->getData()->handle;
+		bool isCompressed = FormatHelper::isCompressed(info.format);
+
+		GLenum type = isCompressed ? GLenum{} : glxGpuFormatType(info.format);
+		GLenum format = isCompressed ? glxColorFormat(info.format) : glxGpuDataFormat(info.format);
+
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, it->second->getExtendedData()->handle);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		for (auto &region : staged) {
+
+			const TextureRange &range = region.first;
+			const void *src = (const void*) usz(allocation.second + region.second);
+
+			if (isCompressed)
+				glxCompressedTextureSubImage(
+					handle, info.textureType, range.mip, range.start, range.size, format,
+					GLsizei(FormatHelper::getImageBytes(info.format, range.size.x, range.size.y, range.size.z)), src
+				);
+
+			else glxTextureSubImage(handle, info.textureType, range.mip, range.start, range.size, format, type, src);
+		}
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	void ReadbackBuffer::prepare(Graphics &g, CommandList::Data*) {
+
+		allocation = { 0, u64_MAX };
+
+		if (!buffer || !uploadBuffer) {
+			oic::System::log()->error("Readback buffer requires a buffer and upload buffer");
+			return;
+		}
+
+		if (offset >= buffer->size() || (size && size > buffer->size() - offset)) {
+			oic::System::log()->error("Readback buffer out of bounds");
+			return;
+		}
+
+		length = size ? size : buffer->size() - offset;
+		allocation = uploadBuffer->reserve(context.executionId, length, 4);
+	}
+
+	void ReadbackBuffer::execute(Graphics &g, CommandList::Data*) const {
+
+		if (allocation.second == u64_MAX) {
+			oic::System::log()->error("Readback buffer ignored; no memory was allocated");
+			return;
+		}
+
+		auto &buffers = uploadBuffer->getInfo().buffers;
+		auto it = buffers.find(allocation.first);
+
+		if (it == buffers.end()) {
+			oic::System::log()->error("Readback buffer isn't found in the upload buffer");
+			return;
+		}
+
+		//Make shader writes visible to the copy and the copy visible to the mapped memory
+
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+		glCopyNamedBufferSubData(
+			buffer->getExtendedData()->handle, it->second->getExtendedData()->handle,
+			GLintptr(offset + buffer->getRegionOffset()), GLintptr(allocation.second), GLsizeiptr(length)
+		);
+
+		glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+
+		context.readbacks.push_back({ 
+			instance, callback, 
+			buffer, uploadBuffer,
+			allocation, offset, length
+		});
+	}
+
 	//Debugging
 
 	#ifndef NDEBUG
@@ -168,6 +168,15 @@ namespace ignis {
 		else if(isStencil)
 			oic::System::log()->fatal("Stencil requested for cpu present, but color image doesn't have one");
 
+		else if(FormatHelper::isCompressed(info.format))
+			oic::System::log()->fatal("Compressed textures can't be presented to cpu");
+
+		else if (FormatHelper::isPacked(info.format)) {
+			format = glxGpuDataFormat(info.format);
+			type = glxGpuFormatType(info.format);
+			stride = FormatHelper::getSizeBytes(info.format);
+		}
+
 		else {
 
 			switch (FormatHelper::getChannelCount(info.format)) {
@@ -196,7 +205,11 @@ namespace ignis {
 		
 		List<GPUObject*> objects = executeInternal(commands, false);
 
-		Pair<u64, u64> allocation = result->allocate(data->executionId, nullptr, target->size(mip, isStencil), 1);
+		//Only the requested region is read back
+
+		usz textureSize = size.prod<usz>() * stride;
+
+		Pair<u64, u64> allocation = result->reserve(data->executionId, textureSize, 1);
 
 		oicAssert("Out of memory exception", allocation.second != u64_MAX);
 
@@ -228,8 +241,6 @@ namespace ignis {
 		else
 			offset.z = std::max(layer, offset.z);
 
-		usz textureSize = size.prod<usz>() * stride;
-
 		glGetTextureSubImage(
 			target->getData()->handle,
 			mip,
@@ -405,7 +416,7 @@ namespace ignis {
 			ctx.boundObjects[GL_DRAW_FRAMEBUFFER] = {};
 
 			glBlitNamedFramebuffer(
-				intermediate->getData()->framebuffer[size_t(slice) * intermediate->getInfo().mips + mip],
+				glxTextureFramebuffer(ctx, intermediate, slice, u8(mip)),
 				0,
 				0, 0, size.x, size.y,
 				0, 0, size.x, size.y,
@@ -527,7 +538,46 @@ namespace ignis {
 				bound.second = {};
 			}
 
-		//Clean up left over VAOs
+		//Patch VAOs and bindings that reference resized buffers
+
+		if (ctx.resizedBuffers.size()) {
+
+			for (auto &vao : ctx.vaos) {
+
+				auto *prim = vao.first.get<PrimitiveBuffer>();
+
+				if (!prim)
+					continue;
+
+				auto &info = prim->getInfo();
+				GLuint i{};
+
+				for (auto &v : info.vertexLayout) {
+
+					if (std::find(ctx.resizedBuffers.begin(), ctx.resizedBuffers.end(), v.buffer->getId()) != ctx.resizedBuffers.end())
+						glVertexArrayVertexBuffer(
+							vao.second, i, v.buffer->getExtendedData()->handle, 
+							v.bufferOffset + v.buffer->getRegionOffset(), v.stride()
+						);
+
+					++i;
+				}
+
+				if (
+					prim->hasIndices() && 
+					std::find(ctx.resizedBuffers.begin(), ctx.resizedBuffers.end(), info.indexLayout.buffer->getId()) != ctx.resizedBuffers.end()
+				)
+					glVertexArrayElementBuffer(vao.second, info.indexLayout.buffer->getExtendedData()->handle);
+			}
+
+			for (auto &bound : ctx.boundObjects)
+				if (std::find(ctx.resizedBuffers.begin(), ctx.resizedBuffers.end(), bound.second) != ctx.resizedBuffers.end())
+					bound.second = {};
+
+			ctx.resizedBuffers.clear();
+		}
+
+		//Clean up left over VAOs and texture framebuffers
 
 		auto &deleted = g.getDeletedObjects();
 
@@ -536,7 +586,11 @@ namespace ignis {
 			if (del.type == GPUObjectType::PRIMITIVE_BUFFER) {
 				glDeleteVertexArrays(1, &ctx.vaos[del]);
 				ctx.vaos.erase(del);
+				ctx.vaoRegions.erase(del);
 			}
+
+			else if (del.type == GPUObjectType::TEXTURE)
+				glxReleaseTextureFramebuffers(ctx, del);
 		}
 
 		deleted.clear();
@@ -575,7 +629,7 @@ namespace ignis {
 		for (auto *res : resources)
 			res->addRef();
 
-		//Queue fence
+		//Queue fence; readbacks issued by this execution finish with it
 
 		ctx.fences[ctx.executionId] = { 
 			glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), 
@@ -589,9 +643,11 @@ namespace ignis {
 			size,
 			layer,
 			mip,
-			isStencil
+			isStencil,
+			std::move(ctx.readbacks)
 		};
 
+		ctx.readbacks.clear();
 	}
 
 	void Graphics::Data::destroyContext() {
@@ -601,6 +657,21 @@ namespace ignis {
 		for(auto &vao : context.vaos)
 			glDeleteVertexArrays(1, &vao.second);
 
+		for (auto &tex : context.textureFramebuffers)
+			for (auto &fb : tex.second)
+				glDeleteFramebuffers(1, &fb.second);
+
+		for (GLuint fb : context.framebufferPool)
+			glDeleteFramebuffers(1, &fb);
+
+		if (contexts.size() == 1) {
+
+			for (auto &program : programs)
+				glDeleteProgram(program.second);
+
+			programs.clear();
+		}
+
 		contexts.erase(oic::Thread::getCurrentId());
 	}
 
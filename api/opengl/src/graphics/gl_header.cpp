@@ -7,6 +7,7 @@
 #include "graphics/memory/gl_gpu_buffer.hpp"
 #include "graphics/memory/gl_texture_object.hpp"
 #include "graphics/shader/gl_sampler.hpp"
+#include "graphics/shader/gl_descriptors.hpp"
 #include "graphics/gl_graphics.hpp"
 #include "graphics/gl_context.hpp"
 
@@ -104,6 +105,58 @@ GLenum glxColorFormat(GPUFormat format){
 
 		case GPUFormat::srgba8:	return GL_SRGB8_ALPHA8;
 
+		case GPUFormat::bc1:		return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		case GPUFormat::bc2:		return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+		case GPUFormat::bc3:		return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case GPUFormat::bc4:		return GL_COMPRESSED_RED_RGTC1;
+		case GPUFormat::bc4s:		return GL_COMPRESSED_SIGNED_RED_RGTC1;
+		case GPUFormat::bc5:		return GL_COMPRESSED_RG_RGTC2;
+		case GPUFormat::bc5s:		return GL_COMPRESSED_SIGNED_RG_RGTC2;
+		case GPUFormat::bc6h:		return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+		case GPUFormat::bc6hs:		return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+		case GPUFormat::bc7:		return GL_COMPRESSED_RGBA_BPTC_UNORM;
+
+		case GPUFormat::bc1srgb:	return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+		case GPUFormat::bc2srgb:	return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+		case GPUFormat::bc3srgb:	return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+		case GPUFormat::bc7srgb:	return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+
+		case GPUFormat::etc2:		return GL_COMPRESSED_RGB8_ETC2;
+		case GPUFormat::etc2a1:		return GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+		case GPUFormat::etc2a8:		return GL_COMPRESSED_RGBA8_ETC2_EAC;
+		case GPUFormat::eacr11:		return GL_COMPRESSED_R11_EAC;
+		case GPUFormat::eacr11s:	return GL_COMPRESSED_SIGNED_R11_EAC;
+		case GPUFormat::eacrg11:	return GL_COMPRESSED_RG11_EAC;
+		case GPUFormat::eacrg11s:	return GL_COMPRESSED_SIGNED_RG11_EAC;
+
+		case GPUFormat::etc2srgb:	return GL_COMPRESSED_SRGB8_ETC2;
+		case GPUFormat::etc2a1srgb:	return GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+		case GPUFormat::etc2a8srgb:	return GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;
+
+		case GPUFormat::astc4x4:	return GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+		case GPUFormat::astc5x5:	return GL_COMPRESSED_RGBA_ASTC_5x5_KHR;
+		case GPUFormat::astc6x6:	return GL_COMPRESSED_RGBA_ASTC_6x6_KHR;
+		case GPUFormat::astc8x8:	return GL_COMPRESSED_RGBA_ASTC_8x8_KHR;
+		case GPUFormat::astc10x10:	return GL_COMPRESSED_RGBA_ASTC_10x10_KHR;
+		case GPUFormat::astc12x12:	return GL_COMPRESSED_RGBA_ASTC_12x12_KHR;
+
+		case GPUFormat::astc4x4srgb:	return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR;
+		case GPUFormat::astc5x5srgb:	return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR;
+		case GPUFormat::astc6x6srgb:	return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR;
+		case GPUFormat::astc8x8srgb:	return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR;
+		case GPUFormat::astc10x10srgb:	return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x10_KHR;
+		case GPUFormat::astc12x12srgb:	return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR;
+
+		case GPUFormat::rgb10a2:	return GL_RGB10_A2;
+		case GPUFormat::rgb10a2u:	return GL_RGB10_A2UI;
+		case GPUFormat::r11g11b10f:	return GL_R11F_G11F_B10F;
+		case GPUFormat::rgb9e5:		return GL_RGB9_E5;
+		case GPUFormat::rgb565:		return GL_RGB565;
+
+		case GPUFormat::rgb10a2s:
+			oic::System::log()->fatal("rgb10a2s is only supported as vertex attribute");
+			return GL_RGBA8;
+
 		case GPUFormat::r64f:    case GPUFormat::r64u:    case GPUFormat::r64i:
 		case GPUFormat::rg64f:   case GPUFormat::rg64u:   case GPUFormat::rg64i:
 		case GPUFormat::rgb64f:  case GPUFormat::rgb64u:  case GPUFormat::rgb64i:
@@ -142,6 +195,15 @@ GLenum glxBufferType(GPUBufferType format) {
 
 GLenum glxGpuFormatType(GPUFormat type) {
 
+	switch (type.value) {
+		case GPUFormat::rgb10a2:	case GPUFormat::rgb10a2u:	return GL_UNSIGNED_INT_2_10_10_10_REV;
+		case GPUFormat::rgb10a2s:	return GL_INT_2_10_10_10_REV;
+		case GPUFormat::r11g11b10f:	return GL_UNSIGNED_INT_10F_11F_11F_REV;
+		case GPUFormat::rgb9e5:		return GL_UNSIGNED_INT_5_9_9_9_REV;
+		case GPUFormat::rgb565:		return GL_UNSIGNED_SHORT_5_6_5;
+		default:					break;
+	}
+
 	const GPUFormatType t = FormatHelper::getType(type);
 	const usz stride = FormatHelper::getStrideBits(type);
 
@@ -177,6 +239,9 @@ error:
 }
 
 GLenum glxGpuDataFormat(GPUFormat format) {
+
+	if (format == GPUFormat::rgb10a2u)
+		return GL_RGBA_INTEGER;
 	
 	switch (FormatHelper::getChannelCount(format)) {
 
@@ -702,135 +767,147 @@ void glxBindPipeline(GLContext &ctx, Pipeline *pipeline) {
 	}
 }
 
+GLuint glxTextureView(TextureObject *tex, const GPUSubresource &subresource, u32 &generation) {
+
+	auto &range = subresource.textureRange;
+	auto *data = tex->getData();
+
+	//Render textures that aren't sized yet don't have storage to view;
+	//keep the generation out of date, so the view is resolved again when it's bound
+
+	if (!data->handle) {
+		generation = data->viewGeneration - 1;
+		return 0;
+	}
+
+	generation = data->viewGeneration;
+
+	u64 key = TextureObject::Data::viewKey(range);
+	auto &textureView = data->textureViews[key];
+
+	if (textureView)
+		return textureView;
+
+	glGenTextures(1, &textureView);
+	glTextureView(
+		textureView,
+		glxTextureType(range.subType),
+		data->handle,
+		glxColorFormat(tex->getInfo().format),
+		range.minLevel,
+		range.levelCount,
+		range.minLayer,
+		range.layerCount
+	);
+
+	String name = 
+			tex->getName() + " " + 
+			std::to_string(data->textureViews.size() - 1);
+
+	glObjectLabel(
+		GL_TEXTURE, textureView, GLsizei(name.size()), name.c_str()
+	);
+
+	if (data->baseLevel)
+		glTextureParameteri(textureView, GL_TEXTURE_BASE_LEVEL, TextureObject::Data::viewBaseLevel(key, data->baseLevel));
+
+	return textureView;
+}
+
 void glxBindDescriptors(GLContext &ctx, const List<Descriptors*> &descriptors) {
 
 	if (descriptors.empty())
 		return;
 
 	for(Descriptors *desc : descriptors)
-		for (auto &mapIt : desc->getInfo().pipelineLayout->getInfo()) {
+		for (auto &binding : desc->getData()->bindings) {
 
-			auto resource = mapIt.second;
-			auto it = desc->getInfo().flushedResources.find(resource.globalId);
+			auto &resource = *binding.layout;
+			auto &subres = binding.subresource;
 
-			if (it != desc->getInfo().flushedResources.end()) {
+			//TODO: Handle nullptr!
 
-				auto &subres = it->second;
-				auto *res = subres.resource;
+			TextureObject *tex = binding.texture;
 
-				//TODO: Handle nullptr!
+			//Bind buffer range
 
-				TextureObject *tex = dynamic_cast<TextureObject*>(res);
+			if (GPUBuffer *buffer = binding.buffer) {
 
-				//Bind buffer range
+				usz offset = subres.bufferRange.offset + buffer->getRegionOffset(), size = subres.bufferRange.size;
 
-				if (GPUBuffer *buffer = dynamic_cast<GPUBuffer*>(res)) {
+				GLenum bindPoint = resource.type == ResourceType::CBUFFER ? GL_UNIFORM_BUFFER :		GL_SHADER_STORAGE_BUFFER;
+				auto &bound = ctx.boundByBaseId[(u64(resource.localId) << 32) | bindPoint];
 
-					usz offset = subres.bufferRange.offset, size = subres.bufferRange.size;
+				u32 generation = buffer->getExtendedData()->generation;
 
-					GLenum bindPoint = resource.type == ResourceType::CBUFFER ? GL_UNIFORM_BUFFER :		GL_SHADER_STORAGE_BUFFER;
-					auto &bound = ctx.boundByBaseId[(u64(resource.localId) << 32) | bindPoint];
+				if (bound.id == buffer->getId() && bound.offset == offset && bound.size == size && bound.subId == generation)
+					continue;
 
-					if (bound.id == buffer->getId() && bound.offset == offset && bound.size == size)
-						continue;
+				glBindBufferRange(
+					bindPoint, resource.localId, buffer->getExtendedData()->handle, offset, size
+				);
 
-					glBindBufferRange(
-						bindPoint, resource.localId, buffer->getExtendedData()->handle, offset, size
-					);
+				bound = { buffer->getId(), offset, size, {}, generation };
+			}
 
-					bound = { buffer->getId(), offset, size };
-				}
+			//Bind sampler range
 
-				//Bind sampler range
+			else if (Sampler *sampler = binding.sampler) {
 
-				else if (Sampler *sampler = dynamic_cast<Sampler*>(res)) {
+				auto &bound = ctx.boundByBaseId[(u64(resource.localId) << 32) | GL_SAMPLER];
 
-					auto &bound = ctx.boundByBaseId[(u64(resource.localId) << 32) | GL_SAMPLER];
+				if (bound.id != sampler->getId()) {
+					glBindSampler(resource.localId, sampler->getData()->handle);
+					bound.id = sampler->getId();
+				}
+			}
 
-					if (bound.id != sampler->getId()) {
-						glBindSampler(resource.localId, sampler->getData()->handle);
-						bound.id = sampler->getId();
-					}
+			//Bind texture
 
-					tex = subres.samplerData.texture;
-				}
+			if (tex) {
 
-				//Bind texture
+				//Views are resolved when the descriptors are flushed; only resized textures have to resolve them again
 
-				if (tex) {
+				if (binding.viewGeneration != tex->getData()->viewGeneration)
+					binding.textureView = glxTextureView(tex, subres, binding.viewGeneration);
 
-					auto &textureViews = tex->getData()->textureViews;
-					GLuint textureView{};
+				GLuint textureView = binding.textureView;
+				u32 subId = textureView;
 
-					u32 subId{};
+				if (!resource.isWritable) {
 
-					for (auto &view : textureViews)
-						if (view.first == subres.textureRange) {
-							textureView = view.second;
-							break;
-						}
-						else ++subId;
+					auto &boundTex = ctx.boundByBaseId[(u64(resource.localId) << 32) | GL_TEXTURE];
 
-					if (!textureView) {
+					if (
+						boundTex.id != tex->getId() || 
+						boundTex.subId != subId ||
+						boundTex.dims != tex->getDimensions(0)
+					) {
+						glBindTextureUnit(resource.localId, textureView);
+						boundTex.subId = subId;
+						boundTex.id = tex->getId();
+						boundTex.dims = tex->getDimensions(0);
+					}
 
-						glGenTextures(1, &textureView);
-						glTextureView(
-							textureView,
-							glxTextureType(subres.textureRange.subType),
-							tex->getData()->handle,
-							glxColorFormat(tex->getInfo().format),
-							subres.textureRange.minLevel,
-							subres.textureRange.levelCount,
-							subres.textureRange.minLayer,
-							subres.textureRange.layerCount
-						);
+				} else {
 
-						String name = 
-								tex->getName() + " " + 
-								std::to_string(textureViews.size());
+					auto &boundImg = ctx.boundByBaseId[(u64(resource.localId) << 32) | GL_IMAGE_2D /* Not 2D but	 GL_IMAGE doesn't exist*/];
 
-						glObjectLabel(
-							GL_TEXTURE, textureView, GLsizei(name.size()), name.c_str()
-						);
+					if (
+						boundImg.id != tex->getId() || 
+						boundImg.subId != subId ||
+						boundImg.dims != tex->getDimensions(0)
+					) {
 
-						textureViews.push_back({ subres.textureRange, textureView });
-					}
+						glBindImageTexture(
+							resource.localId, textureView, 0,
+							GL_TRUE, 0, GL_WRITE_ONLY,
+							glxColorFormat(tex->getInfo().format)
+						);
 
-					if (!resource.isWritable) {
-
-						auto &boundTex = ctx.boundByBaseId[(u64(resource.localId) << 32) | GL_TEXTURE];
-
-						if (
-							boundTex.id != tex->getId() || 
-							boundTex.subId != subId ||
-							boundTex.dims != tex->getDimensions(0)
-						) {
-							glBindTextureUnit(resource.localId, textureView);
-							boundTex.subId = subId;
-							boundTex.id = tex->getId();
-							boundTex.dims = tex->getDimensions(0);
-						}
-
-					} else {
-
-						auto &boundImg = ctx.boundByBaseId[(u64(resource.localId) << 32) | GL_IMAGE_2D /* Not 2D but	 GL_IMAGE doesn't exist*/];
-
-						if (
-							boundImg.id != tex->getId() || 
-							boundImg.subId != subId ||
-							boundImg.dims != tex->getDimensions(0)
-						) {
-
-							glBindImageTexture(
-								resource.localId, textureView, 0,
-								GL_TRUE, 0, GL_WRITE_ONLY,
-								glxColorFormat(tex->getInfo().format)
-							);
-
-							boundImg.subId = subId;
-							boundImg.id = tex->getId();
-							boundImg.dims = tex->getDimensions(0);
-						}
+						boundImg.subId = subId;
+						boundImg.id = tex->getId();
+						boundImg.dims = tex->getDimensions(0);
 					}
 				}
 			}
@@ -839,6 +916,56 @@ void glxBindDescriptors(GLContext &ctx, const List<Descriptors*> &descriptors) {
 
 //Per context
 
+GLuint glxTextureFramebuffer(GLContext &ctx, TextureObject *tex, u16 layer, u8 mip) {
+
+	auto &info = tex->getInfo();
+	GLuint &fb = ctx.textureFramebuffers[tex->getId()][u32(mip) * info.layers + layer];
+
+	if (fb)
+		return fb;
+
+	if (ctx.framebufferPool.size()) {
+		fb = ctx.framebufferPool.back();
+		ctx.framebufferPool.pop_back();
+	}
+
+	else glCreateFramebuffers(1, &fb);
+
+	const String &name = tex->getName();
+	glObjectLabel(GL_FRAMEBUFFER, fb, GLsizei(name.size()), name.c_str());
+
+	GLenum colorAttachment = GL_COLOR_ATTACHMENT0;
+
+	if (info.layers > 1)
+		glNamedFramebufferTextureLayer(fb, colorAttachment, tex->getData()->handle, mip, layer);
+	else
+		glNamedFramebufferTexture(fb, colorAttachment, tex->getData()->handle, mip);
+
+	glNamedFramebufferDrawBuffers(fb, 1, &colorAttachment);
+
+	if (glCheckNamedFramebufferStatus(fb, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		oic::System::log()->fatal("Couldn't create GPU write target");
+
+	return fb;
+}
+
+void glxReleaseTextureFramebuffers(GLContext &ctx, const GPUObjectId &tex) {
+
+	auto it = ctx.textureFramebuffers.find(tex);
+
+	if (it == ctx.textureFramebuffers.end())
+		return;
+
+	//Detach, so the pool doesn't keep the texture alive
+
+	for (auto &fb : it->second) {
+		glNamedFramebufferTexture(fb.second, GL_COLOR_ATTACHMENT0, 0, 0);
+		ctx.framebufferPool.push_back(fb.second);
+	}
+
+	ctx.textureFramebuffers.erase(it);
+}
+
 GLuint glxGenerateVao(PrimitiveBuffer *prim) {
 	
 	GLuint handle;
@@ -862,11 +989,19 @@ GLuint glxGenerateVao(PrimitiveBuffer *prim) {
 		}
 
 		glVertexArrayVertexBuffer(
-			handle, i, v.buffer->getExtendedData()->handle, v.bufferOffset, v.stride()
+			handle, i, v.buffer->getExtendedData()->handle, v.bufferOffset + v.buffer->getRegionOffset(), v.stride()
 		);
 
 		for (auto &elem : v.formats) {
 
+			//Only 2_10_10_10 and 10F_11F_11F are packed vertex formats
+
+			if (elem.format == GPUFormat::rgb9e5 || elem.format == GPUFormat::rgb565) {
+				oic::System::log()->error("rgb9e5 and rgb565 aren't supported as vertex attribute");
+				glDeleteVertexArrays(1, &handle);
+				return 0;
+			}
+
 			glEnableVertexArrayAttrib(handle, elem.index);
 			glVertexArrayAttribFormat(
 				handle,
@@ -913,4 +1048,36 @@ GLuint glxGenerateVao(PrimitiveBuffer *prim) {
 	}
 
 	return handle;
+}
+
+void glxUpdateVaoRegions(GLContext &ctx, GLuint vao, PrimitiveBuffer *prim) {
+
+	auto &info = prim->getInfo();
+	List<u64> *regions{};
+
+	u32 i{};
+
+	for (auto &v : info.vertexLayout) {
+
+		if (v.buffer->isDynamic()) {
+
+			if (!regions) {
+				regions = &ctx.vaoRegions[prim->getId()];
+				regions->resize(info.vertexLayout.size());
+			}
+
+			u64 &region = (*regions)[i];
+
+			if (region != v.buffer->getRegionOffset()) {
+
+				region = v.buffer->getRegionOffset();
+
+				glVertexArrayVertexBuffer(
+					vao, i, v.buffer->getExtendedData()->handle, v.bufferOffset + region, v.stride()
+				);
+			}
+		}
+
+		++i;
+	}
 }
\ No newline at end of file
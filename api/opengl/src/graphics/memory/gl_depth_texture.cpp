@@ -30,6 +30,7 @@ namespace ignis {
 			}
 
 		data->textureViews.clear();
+		++data->viewGeneration;
 
 		if (data->handle) {
 
@@ -66,6 +66,27 @@ namespace ignis {
 			*(volatile u8*)(dst + off) = *(const u8*)(src + off);
 	}
 
+	volatile u8 *glxMapBuffer(GLuint handle, GPUMemoryUsage usage, u64 size) {
+
+		GLenum mapFlags = GL_MAP_PERSISTENT_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+		bool hasCpuAccess{};
+
+		if (HasFlags(usage, GPUMemoryUsage::CPU_WRITE)) {
+			mapFlags |= GL_MAP_WRITE_BIT;
+			hasCpuAccess = true;
+		}
+
+		if (HasFlags(usage, GPUMemoryUsage::CPU_READ)) {
+			mapFlags |= GL_MAP_READ_BIT;
+			hasCpuAccess = true;
+		}
+
+		if (hasCpuAccess && HasFlags(usage, GPUMemoryUsage::SHARED))
+			return (volatile u8*)glMapNamedBufferRange(handle, 0, size, mapFlags);
+
+		return nullptr;
+	}
+
 	GPUBuffer::GPUBuffer(Graphics &g, const String &name, const Info &inf, GPUObjectType type):
 		GPUObject(g, name, type), info(inf) {
 
@@ -78,26 +99,84 @@ namespace ignis {
 
 		glObjectLabel(GL_BUFFER, handle, GLsizei(name.size()), name.c_str());
 
+		//Dynamic buffers have N regions; aligned so every region can be bound as a uniform buffer
+
+		u64 storageSize = inf.size;
+
+		if (isDynamic()) {
+			data->regionSize = (inf.size + 255) & ~255_u64;
+			data->regionExecutionIds.resize(inf.regions);
+			storageSize = data->regionSize * inf.regions;
+		}
+
 		glNamedBufferStorage(
-			handle, inf.size, {},
+			handle, storageSize, {},
 			glxBufferUsage(inf.usage)
 		);
 
-		GLenum mapFlags = GL_MAP_PERSISTENT_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
-		bool hasCpuAccess{};
+		capacity = inf.size;
+		data->unmapped = glxMapBuffer(handle, inf.usage, storageSize);
 
-		if (HasFlags(inf.usage, GPUMemoryUsage::CPU_WRITE)) {
-			mapFlags |= GL_MAP_WRITE_BIT;
-			hasCpuAccess = true;
+		//CPU writable buffers need a CPU copy, so the file has to be loaded
+		//Mapped staging buffers copy it straight into the mapping instead
+
+		if (!info.file.empty() && HasFlags(inf.usage, GPUMemoryUsage::CPU_WRITE) && !info.isMappedStaging()) {
+
+			MappedFile file(info.file.path);
+
+			if (const u8 *ptr = file.get(info.file))
+				info.initData.assign(ptr, ptr + info.file.size);
+
+			else oic::System::log()->fatal("GPUBuffer file region couldn't be read ", info.file.path);
+
+			info.file = {};
 		}
 
-		if (HasFlags(inf.usage, GPUMemoryUsage::CPU_READ)) {
-			mapFlags |= GL_MAP_READ_BIT;
-			hasCpuAccess = true;
+		//Dynamic buffers are written directly; the init data is copied into every region
+
+		if (isDynamic()) {
+
+			if (!data->unmapped)
+				oic::System::log()->fatal("GPUBuffer DYNAMIC couldn't be mapped");
+
+			if (info.initData.size()) {
+
+				for (u8 i = 0; i < inf.regions; ++i)
+					fastCopy(data->unmapped + data->regionSize * i, info.initData.data(), inf.size);
+
+				glFlushMappedNamedBufferRange(handle, 0, GLsizeiptr(storageSize));
+				info.initData.clear();
+			}
+
+			dynamicRegion = (u8*) data->unmapped;
 		}
 
-		if (hasCpuAccess && HasFlags(inf.usage, GPUMemoryUsage::SHARED))
-			data->unmapped = (volatile u8*)glMapNamedBufferRange(handle, 0, inf.size, mapFlags);
+		//Staging buffers are gathered into straight from the source (e.g. a file mapping)
+
+		else if (info.isMappedStaging()) {
+
+			if (!data->unmapped)
+				oic::System::log()->fatal("GPUBuffer STAGING couldn't be mapped");
+
+			mappedStaging = (u8*) data->unmapped;
+
+			if (!info.file.empty()) {
+
+				MappedFile file(info.file.path);
+
+				if (const u8 *ptr = file.get(info.file))
+					fastCopy(data->unmapped, ptr, inf.size);
+
+				else oic::System::log()->fatal("GPUBuffer file region couldn't be read ", info.file.path);
+
+				info.file = {};
+			}
+
+			else if (info.initData.size()) {
+				fastCopy(data->unmapped, info.initData.data(), inf.size);
+				info.initData.clear();
+			}
+		}
 	}
 
 	GPUBuffer::~GPUBuffer() {
@@ -111,6 +190,34 @@ namespace ignis {
 		delete data;
 	}
 
+	void GPUBuffer::reallocate(u64 newCapacity, u64 copySize) {
+
+		GLuint handle{};
+		glCreateBuffers(1, &handle);
+
+		glObjectLabel(GL_BUFFER, handle, GLsizei(getName().size()), getName().c_str());
+		glNamedBufferStorage(handle, newCapacity, {}, glxBufferUsage(info.usage));
+
+		//Move the contents on the GPU; the old storage is released by the driver once it's unused
+
+		if (copySize)
+			glCopyNamedBufferSubData(data->handle, handle, 0, 0, copySize);
+
+		if (data->unmapped)
+			glUnmapNamedBuffer(data->handle);
+
+		glDeleteBuffers(1, &data->handle);
+
+		data->handle = handle;
+		data->unmapped = glxMapBuffer(handle, info.usage, newCapacity);
+		++data->generation;
+
+		//VAOs and bound ranges are patched by every context before its next execution
+
+		for (auto &ctx : getGraphics().getData()->contexts)
+			ctx.second->resizedBuffers.push_back(getId());
+	}
+
 	Pair<u64, u64> GPUBuffer::prepare(CommandList::Data*, UploadBuffer *uploadBuffer) {
 
 		if (!HasFlags(info.usage, GPUMemoryUsage::CPU_WRITE)) {
@@ -123,14 +230,34 @@ namespace ignis {
 				return { 0, u64_MAX };
 			}
 
-			u64 size{};
+			u64 executionId = getGraphics().getData()->getContext().executionId;
+
+			//Stream from the file mapping straight into the upload buffer
 
-			for (auto &pending : info.pending)
-				size += pending.y;
+			if (!info.file.empty()) {
+
+				MappedFile file(info.file.path);
+				const u8 *ptr = file.get(info.file);
+
+				if (!ptr) {
+					oic::System::log()->error("GPUBuffer file region couldn't be read");
+					return { 0, u64_MAX };
+				}
+
+				info.markedPending = true;
+				return uploadBuffer->allocate(executionId, ptr, info.pending, 1);
+			}
+
+			if (info.initData.size() != info.size) {
+				oic::System::log()->error("GPUBuffer doesn't have any backing CPU data");
+				return { 0, u64_MAX };
+			}
 
 			info.markedPending = true;
 
-			return uploadBuffer->allocate(getGraphics().getData()->getContext().executionId, info.initData.data(), size, 1);
+			//Only the pending ranges are packed into the upload buffer (in order)
+
+			return uploadBuffer->allocate(executionId, info.initData.data(), info.pending, 1);
 		}
 
 		return { 0, u64_MAX };
@@ -138,6 +265,11 @@ namespace ignis {
 
 	void GPUBuffer::flush(CommandList::Data*, UploadBuffer *uploadBuffer, const Pair<u64, u64> &allocation){
 
+		if (isDynamic()) {
+			flushDynamic();
+			return;
+		}
+
 		if (info.pending.empty())
 			return;
 
@@ -146,7 +278,7 @@ namespace ignis {
 			if (allocation.second == u64_MAX)
 				return;
 
-			if (info.initData.size() != info.size) {
+			if (info.initData.size() != info.size && info.file.empty()) {
 				oic::System::log()->error("GPUBuffer doesn't have any backing CPU data");
 				return;
 			}
@@ -161,6 +293,8 @@ namespace ignis {
 
 			GPUBuffer *buf = it->second;
 
+			//Scatter the packed ranges to their destinations
+
 			u64 offset{};
 
 			for (auto &pending : info.pending) {
@@ -175,6 +309,7 @@ namespace ignis {
 			}
 
 			info.initData.clear();
+			info.file = {};
 		}
 
 		else if (!HasFlags(info.usage, GPUMemoryUsage::SHARED) && !uploadBuffer) {
@@ -186,10 +321,10 @@ namespace ignis {
 
 			for (auto &pending : info.pending) {
 
-				const u8 *start = info.initData.data() + pending.x;
-				volatile u8 *ptr = data->unmapped + pending.x;
+				//Mapped staging buffers were already written through the mapping
 
-				fastCopy(ptr, start, pending.y);
+				if (!mappedStaging)
+					fastCopy(data->unmapped + pending.x, info.initData.data() + pending.x, pending.y);
 
 				glFlushMappedNamedBufferRange(data->handle, GLintptr(pending.x), GLsizeiptr(pending.y));
 			}
@@ -203,9 +338,85 @@ namespace ignis {
 		info.markedPending = false;
 	}
 
+	void GPUBuffer::flushDynamic() {
+
+		GLContext &ctx = getGraphics().getData()->getContext();
+
+		//Buffers shared by multiple layouts or flushed multiple times only rotate once per execution
+
+		if (data->flushExecution == ctx.executionId)
+			return;
+
+		data->flushExecution = ctx.executionId;
+
+		//Publish the written region
+
+		u64 writeOffset = data->regionSize * data->writeRegion;
+
+		if (info.pending.empty())
+			glFlushMappedNamedBufferRange(data->handle, GLintptr(writeOffset), GLsizeiptr(info.size));
+
+		else for (auto &pending : info.pending)
+			glFlushMappedNamedBufferRange(data->handle, GLintptr(writeOffset + pending.x), GLsizeiptr(pending.y));
+
+		info.pending.clear();
+
+		//The previous region is read by the previous execution,
+		//or by this one as well if commands already ran before this flush
+
+		if (data->region != data->writeRegion)
+			data->regionExecutionIds[data->region] = 
+				ctx.commandExecutionId == ctx.executionId ? ctx.executionId : ctx.executionId - 1;
+
+		data->region = data->writeRegion;
+		regionOffset = writeOffset;
+
+		//Move to the next region; the GPU is waited on when the CPU writes to it (acquireDynamic)
+
+		data->writeRegion = u8((data->writeRegion + 1) % info.regions);
+		dynamicRegion = (u8*) data->unmapped + data->regionSize * data->writeRegion;
+	}
+
+	u8 *GPUBuffer::acquireDynamic() const {
+
+		u64 &lastExecution = data->regionExecutionIds[data->writeRegion];
+
+		if (lastExecution) {
+
+			GLContext &ctx = getGraphics().getData()->getContext();
+
+			auto it = ctx.fences.find(lastExecution);
+
+			if (it != ctx.fences.end())
+				glClientWaitSync(it->second.sync, GL_SYNC_FLUSH_COMMANDS_BIT, u64_MAX);
+
+			//There's no fence yet for the current execution
+
+			else if (lastExecution == ctx.executionId) {
+
+				#ifdef IGNIS_STRICT_PERFORMANCE_WARNINGS
+					oic::System::log()->performance("GPUBuffer DYNAMIC written while the current execution could still read the region");
+				#endif
+
+				glFinish();
+			}
+
+			lastExecution = 0;
+		}
+
+		return dynamicRegion;
+	}
+
 	Buffer GPUBuffer::readback(u64 offset, u64 size) {
 		oicAssert("Can only readback from CPU visible memory", data->unmapped);
 		oicAssert("Read out of bounds", offset + size <= info.size);
+		offset += regionOffset;
 		return Buffer(data->unmapped + offset, data->unmapped + offset + size);
 	}
+
+	const u8 *GPUBuffer::readbackView(u64 offset, u64 size) const {
+		oicAssert("Can only readback from CPU visible memory", data->unmapped);
+		oicAssert("Read out of bounds", offset + size <= info.size);
+		return (const u8*) data->unmapped + regionOffset + offset;
+	}
 }
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include "graphics/memory/gl_texture_object.hpp"
 #include "graphics/memory/depth_texture.hpp"
+#include "graphics/memory/gl_gpu_buffer.hpp"
+#include "graphics/memory/upload_buffer.hpp"
+#include "graphics/gl_context.hpp"
+#include "graphics/format_converter.hpp"
 #include "graphics/gl_graphics.hpp"
 #include "utils/math.hpp"
 #include "utils/hash.hpp"
@@ -7,21 +11,105 @@
 #include "system/system.hpp"
 
 namespace ignis {
+
+	void glxTextureSubImage(
+		GLuint handle, TextureType textureType, u8 mip, 
+		const Vec3u16 &start, const Vec3u16 &size, 
+		GLenum format, GLenum type, const void *src
+	) {
+
+		switch (textureType) {
+
+			case TextureType::TEXTURE_1D:
+
+				glTextureSubImage1D(
+
+					handle,
+
+					mip,
+
+					start.x,
+					size.x, 
+
+					format,
+					type,
+					src
+				);
+
+				break;
+
+			case TextureType::TEXTURE_1D_ARRAY:
+			case TextureType::TEXTURE_2D:
+
+				glTextureSubImage2D(
+
+					handle,
+					
+					mip,
+
+					start.x,
+					start.y,
+
+					size.x,
+					size.y,
+
+					format,
+					type,
+					src
+				);
+
+				break;
+
+			default:
+
+				glTextureSubImage3D(
+
+					handle,
+					
+					mip,
+
+					start.x,
+					start.y,
+					start.z,
+
+					size.x,
+					size.y,
+					size.z,
+
+					format,
+					type,
+					src
+				);
+		}
+	}
+	
+	void glxCompressedTextureSubImage(
+		GLuint handle, TextureType textureType, u8 mip, 
+		const Vec3u16 &start, const Vec3u16 &size, 
+		GLenum format, GLsizei imageSize, const void *src
+	) {
+
+		if (textureType == TextureType::TEXTURE_2D)
+			glCompressedTextureSubImage2D(handle, mip, start.x, start.y, size.x, size.y, format, imageSize, src);
+
+		else glCompressedTextureSubImage3D(
+			handle, mip, start.x, start.y, start.z, size.x, size.y, size.z, format, imageSize, src
+		);
+	}
 	
 	Texture::Texture(Graphics &g, const String &name, const Info &inf) :
 		TextureObject(g, name, inf, GPUObjectType::TEXTURE), info(inf)
 	{
-		for(u8 i{}; i < inf.mips; ++i) {
+		if (inf.needsConversion() && !FormatConverter::canConvert(inf.getDataFormat(), inf.format))
+			oic::System::log()->fatal("Texture data format can't be converted to the texture format");
 
-			auto mipSize = inf.mipSizes[i];
+		//Streaming textures start without resident mips; they're uploaded in flush within the budget
 
-			auto &layer = mipSize.arr[getDimensionLayerId()];
-			layer = std::max(layer, inf.layers);
+		if (inf.isStreaming)
+			residentMip = inf.mips;
 
-			info.pending.push_back(
-				TextureRange { {}, mipSize, i }
-			);
-		}
+		else for(u8 i{}; i < inf.mips; ++i)
+			info.pending.push_back(TextureRange { {}, getDimensions(i), i });
 
 		data = new Data();
 
@@ -31,7 +119,7 @@ namespace ignis {
 		glCreateTextures(glxTextureType(inf.textureType), 1, &data->handle);
 		GLuint handle = data->handle;
 
-		data->textureViews.push_back({ GPUSubresource::TextureRange(0, 0, inf.mips, inf.layers, inf.textureType), handle });
+		data->textureViews[Data::viewKey(GPUSubresource::TextureRange(0, 0, inf.mips, inf.layers, inf.textureType))] = handle;
 		
 		glObjectLabel(GL_TEXTURE, handle, GLsizei(name.size()), name.c_str());
 
@@ -69,58 +157,38 @@ namespace ignis {
 				oic::System::log()->fatal("TextureType not supported");
 		}
 
-		//Create a framebuffer so copy and clear operations can be done for this texture
-
-		if (HasFlags(inf.usage, GPUMemoryUsage::GPU_WRITE)) {
-
-			const String fbName = NAME(name + " framebuffer");
-
-			data->framebuffer.resize(size_t(inf.layers) * inf.mips);
-
-			for (u16 i = 0; i < inf.layers * inf.mips; ++i) {
+		//CPU writable textures need a CPU copy, so the files have to be loaded
 
-				auto &fb = data->framebuffer[i];
+		info.layout();
 
-				glCreateFramebuffers(1, &fb);
-				glObjectLabel(GL_FRAMEBUFFER, fb, GLsizei(fbName.size()), fbName.c_str());
+		if (inf.files.size() && HasFlags(inf.usage, GPUMemoryUsage::CPU_WRITE)) {
 
-				GLenum colorAttachment = GL_COLOR_ATTACHMENT0;
+			List<MappedFile> mapped;
+			info.initData.resize(info.getDataBytes());
 
-				if (inf.layers > 1)
-					glNamedFramebufferTextureLayer(fb, colorAttachment, data->handle, i % inf.mips, i / inf.mips);
-				else
-					glNamedFramebufferTexture(fb, colorAttachment, data->handle, i);
+			for (usz i = 0; i < inf.files.size(); ++i) {
 
-				glNamedFramebufferDrawBuffers(fb, 1, &colorAttachment);
-				GLenum status = glCheckNamedFramebufferStatus(fb, GL_FRAMEBUFFER);
+				auto &region = inf.files[i];
 
-				if (status != GL_FRAMEBUFFER_COMPLETE)
-					oic::System::log()->fatal("Couldn't create GPU write target");
+				if (const u8 *ptr = MappedFile::get(mapped, region))
+					std::memcpy(info.initData.data() + info.subresources[i].offset, ptr, info.subresources[i].size);
 
+				else oic::System::log()->fatal("Texture file region couldn't be read ", region.path);
 			}
+
+			info.files.clear();
 		}
 
 		//Make sure CPU can write into the buffer
 
-		if(!HasFlags(inf.usage, GPUMemoryUsage::NO_CPU_MEMORY) && inf.initData.size() < inf.mips) {
-
-			u8 start = u8(inf.initData.size());
-			info.initData.resize(inf.mips);
-
-			for (u8 i = start; i < inf.mips; ++i)
-				info.initData[i].resize(info.mipSizes[i].prod<usz>() * inf.layers * FormatHelper::getSizeBytes(inf.format));
-
-		}
+		if(!HasFlags(inf.usage, GPUMemoryUsage::NO_CPU_MEMORY) && info.files.empty() && !info.hasData())
+			info.initData.resize(info.getDataBytes());
 	}
 
 	Texture::~Texture() {
 
 		if (!data) return;
 
-		if (HasFlags(info.usage, GPUMemoryUsage::GPU_WRITE))
-			for (u16 i = 0; i < info.layers * info.mips; ++i)
-				glDeleteFramebuffers(1, &data->framebuffer[i]);
-
 		for(auto &views : data->textureViews)
 			if (views.second != data->handle)
 				glDeleteTextures(1, &views.second);
@@ -129,208 +197,348 @@ namespace ignis {
 		destroy(data);
 	}
 
-	Pair<u64, u64> Texture::prepare(CommandList::Data*, UploadBuffer*) {
-		return { 0, u64_MAX };		//Since textures are transfered from the CPU, we don't need an allocation
-	}
+	//A span of CPU memory that is uploaded into a sub region of a mip
+	//Client memory is read with the pitch of the source, so sub regions don't have to be repacked
+	//Staged uploads only copy the rows (rowBytes each) of the sub region, so they're tightly packed
+	//srcSize is in the data format and size / stagedSize in the texture format
 
-	void Texture::flush(CommandList::Data*, UploadBuffer *uploadBuffer, const Pair<u64, u64>&) {
+	struct GLXTextureUpload {
 
-		if (info.pending.empty())
-			return;
+		const u8 *src;
+		u64 srcSize, size, stagedSize, imageSize;
 
-		if (!HasFlags(info.usage, GPUMemoryUsage::SHARED) && !uploadBuffer) {
-			oic::System::log()->error("Even though OpenGL handles UploadBuffers implictly, for non shared memory one is required by the ignis spec");
-			return;
+		u64 rowBytes, rowPitch, slicePitch;
+		u32 rows, slices;
+
+		Vec3u16 start, dim;
+		GLint rowLength, imageHeight, stagedRowLength, stagedImageHeight;
+
+		u8 mip;
+	};
+
+	//Get the uploads of the pending ranges (or file regions) in the order they're staged
+	//If mapped is null, src isn't resolved for files
+	//Streaming textures upload the mips [streamMip, resident) and the pending ranges of resident mips
+
+	static List<GLXTextureUpload> glxTextureUploads(const Texture &tex, u8 streamMip, List<MappedFile> *mapped) {
+
+		auto &info = tex.getInfo();
+		usz blockBytes = FormatHelper::getBlockBytes(info.format);
+		usz srcBlockBytes = FormatHelper::getBlockBytes(info.getDataFormat());
+		usz bw = FormatHelper::getBlockWidth(info.format), bh = FormatHelper::getBlockHeight(info.format);
+
+		u8 firstMip{}, endMip = info.mips, resident{};
+
+		if (info.isStreaming) {
+			resident = std::max(tex.getResidentMip(), tex.getStreamTarget());
+			firstMip = streamMip;
+			endMip = resident;
 		}
 
-		GLuint handle = data->handle;
-		GLenum type = glxGpuFormatType(info.format);
-		GLenum format = glxGpuDataFormat(info.format);
+		List<GLXTextureUpload> uploads;
 
-		for (auto &pending : info.pending) {
+		//Every layer of every mip is stored in its own file region
 
-			if (info.initData.size() <= pending.mip) {
-				oic::System::log()->error("Texture didn't have any backing CPU data");
-				continue;
-			}
+		if (info.files.size()) {
+
+			uploads.reserve(usz(endMip - firstMip) * info.layers);
+
+			for (u8 m = firstMip; m < endMip; ++m) {
 
-			Vec3usz dimensions = getDimensions(pending.mip).cast<Vec3usz>();
+				Vec3u16 size = info.mipSizes[m];
 
-			auto *src = info.initData[pending.mip].data();
-			usz stride = FormatHelper::getSizeBytes(info.format);
+				u16 &layerSize = size.arr[tex.getDimensionLayerId() - 1];
 
-			Buffer copyData;
+				if (info.textureType != TextureType::TEXTURE_3D)
+					layerSize = 1;
 
-			bool needsCopy;
+				for (u16 l = 0; l < info.layers; ++l) {
 
-			switch (info.textureType) {
+					auto &region = info.files[usz(m) * info.layers + l];
 
-				case TextureType::TEXTURE_1D:
-					needsCopy = false;
-					break;
+					Vec3u16 start{};
+					start.arr[tex.getDimensionLayerId() - 1] = l;
 
-				case TextureType::TEXTURE_1D_ARRAY:
-				case TextureType::TEXTURE_2D:
-					needsCopy = pending.size.x != dimensions.x;
-					break;
+					u64 converted = region.size / srcBlockBytes * blockBytes;
 
-				default:
-					needsCopy = pending.size.x != dimensions.x || pending.size.y != dimensions.y;
+					uploads.push_back({ 
+						mapped ? MappedFile::get(*mapped, region) : nullptr, region.size, converted, converted, converted,
+						region.size, region.size, region.size, 1, 1,
+						start, size, 0, 0, 0, 0, m 
+					});
+				}
 			}
 
-			//We need to copy to an intermediate CPU buffer
+			return uploads;
+		}
+
+		List<TextureRange> ranges;
+		ranges.reserve(info.pending.size() + (endMip - firstMip));
+
+		for (auto &pending : info.pending)
+			if (pending.mip >= resident)
+				ranges.push_back(pending);
+
+		if (info.isStreaming)
+			for (u8 m = firstMip; m < endMip; ++m)
+				ranges.push_back(TextureRange{ {}, tex.getDimensions(m), m });
 
-			if (needsCopy) {
+		uploads.reserve(ranges.size());
 
-				copyData.resize(stride * pending.size.prod<usz>());
+		for (auto &pending : ranges) {
+
+			//Layers of a mip are consecutive slices (or rows for 1D arrays)
+
+			auto &sub = info.getSubresource(pending.mip);
+
+			if (info.initData.size() < sub.offset + info.getMipBytes(pending.mip))
+				continue;
 
-				const usz dstRow = pending.size.x * stride;
-				const usz dstSlice = pending.size.y * dstRow;
+			//Only the blocks that the range touches are read; rows of client memory keep the source pitch
 
-				const usz srcRow = dimensions.x * stride;
-				const usz srcSlice = dimensions.y * srcRow;
-				
-				//Copy each line
+			usz startRow = pending.start.y / bh;
+			usz endRow = (pending.start.y + std::max(pending.size.y, u16(1)) + bh - 1) / bh;
 
-				if(
-					info.textureType == TextureType::TEXTURE_1D_ARRAY || 
-					info.textureType == TextureType::TEXTURE_2D
-				)
-					for(
+			usz startBlock = pending.start.x / bw;
+			usz endBlock = (pending.start.x + std::max(pending.size.x, u16(1)) + bw - 1) / bw;
 
-						usz i = 0,
+			usz rows = endRow - startRow, slices = std::max(pending.size.z, u16(1));
+			usz rowBytes = (endBlock - startBlock) * srcBlockBytes;
 
-						srcOff = (pending.start.x + pending.start.y * dimensions.x) * stride,
-						dstOff{}; 
+			usz first = sub.offset + pending.start.z * sub.slicePitch + startRow * sub.rowPitch + startBlock * srcBlockBytes;
+			usz srcSize = (slices - 1) * sub.slicePitch + (rows - 1) * sub.rowPitch + rowBytes;
 
-						i < pending.size.y; 
+			uploads.push_back({
+				info.initData.data() + first, srcSize, srcSize / srcBlockBytes * blockBytes,
+				rowBytes * rows * slices / srcBlockBytes * blockBytes,
+				FormatHelper::getImageBytes(info.format, pending.size.x, pending.size.y, pending.size.z),
+				rowBytes, sub.rowPitch, sub.slicePitch, u32(rows), u32(slices),
+				pending.start, pending.size,
+				GLint(sub.rowPitch / srcBlockBytes * bw), GLint(sub.slicePitch / sub.rowPitch * bh),
+				GLint(rowBytes / srcBlockBytes * bw), GLint(rows * bh),
+				pending.mip
+			});
+		}
 
-						++i,
+		return uploads;
+	}
 
-						srcOff += srcRow,
-						dstOff += dstRow
-					)
-						std::memcpy(copyData.data() + dstOff, src + srcOff, dstRow);
+	Pair<u64, u64> Texture::prepare(CommandList::Data*, UploadBuffer *uploadBuffer) {
 
-				else if(pending.size.x == dimensions.x)
-					for (
+		//Without an upload buffer, data is transfered from CPU memory on flush
 
-						usz i{},
+		u8 streamMip = getStreamMip();
 
-						srcOff = stride * (pending.start.x + (pending.start.y + pending.start.z * dimensions.y) * dimensions.x),
-						dstOff{}; 
+		if (!uploadBuffer || info.markedPending || (info.pending.empty() && streamMip >= residentMip))
+			return { 0, u64_MAX };
 
-						i < pending.size.z; 
+		List<MappedFile> mapped;
+		auto uploads = glxTextureUploads(*this, streamMip, &mapped);
 
-						++i,
+		List<Pair<const u8*, u64>> spans;
+		spans.reserve(uploads.size());
 
-						dstOff += dstSlice
-					)
-						std::memcpy(copyData.data() + dstOff, src + srcOff + srcSlice * i, dstSlice);
+		for (auto &upload : uploads) {
 
-				//Copy each line from a 3D texture
+			if (!upload.src) {
+				oic::System::log()->error("Texture upload couldn't be read");
+				return { 0, u64_MAX };
+			}
 
-				else for(
+			//Only the rows of a sub region are staged, so rows (or slices) that aren't contiguous are split
+			//Adjacent spans (e.g. every mip of the initial upload) are staged as one copy
 
-					usz i{}, j = pending.size.z * usz(pending.size.y),
-					y{}, z{},
+			bool isRowContiguous = upload.rowBytes == upload.rowPitch;
+			bool isSliceContiguous = isRowContiguous && upload.rows * upload.rowPitch == upload.slicePitch;
 
-					srcOff = stride * (pending.start.x + (pending.start.y + pending.start.z * dimensions.y) * dimensions.x),
-					dstOff{}; 
+			u32 spanRows = isRowContiguous ? upload.rows : 1;
+			u32 spanCount = isSliceContiguous ? 1 : (isRowContiguous ? upload.slices : upload.rows * upload.slices);
+			u64 spanBytes = isSliceContiguous ? upload.rowBytes * upload.rows * upload.slices : upload.rowBytes * spanRows;
 
-					i < j; 
+			for (u32 i = 0; i < spanCount; ++i) {
 
-					++i,
+				const u8 *src = upload.src;
 
-					y = i % pending.size.y,
-					z = i / pending.size.y,
+				if (!isSliceContiguous)
+					src += usz(i * spanRows / upload.rows) * upload.slicePitch + usz(i * spanRows % upload.rows) * upload.rowPitch;
 
-					dstOff += dstRow
-				)
-					std::memcpy(copyData.data() + dstOff, src + srcOff + srcRow * y + srcSlice * z, dstRow);
+				if (spans.size() && spans.back().first + spans.back().second == src)
+					spans.back().second += spanBytes;
 
-				src = copyData.data();
+				else spans.push_back({ src, spanBytes });
 			}
+		}
+
+		if (spans.empty())
+			return { 0, u64_MAX };
+
+		//Stage the spans so the driver can copy them asynchronously from the unpack buffer
+
+		u64 executionId = getGraphics().getData()->getContext().executionId;
+
+		auto allocation = info.needsConversion() ?
+			uploadBuffer->allocate(executionId, spans, 16, info.getDataFormat(), info.format, info.swapRB) :
+			uploadBuffer->allocate(executionId, spans, 16);
 
-			//No need to copy, we just need to offset from our CPU data
+		if (allocation.second != u64_MAX)
+			info.markedPending = true;
 
-			else
-				src += stride * (pending.start.x + dimensions.x * (pending.start.y + dimensions.y * pending.start.z));
+		return allocation;
+	}
 
-			//Copy to GPU
+	//Sampling is clamped to the resident mips through the base level of the texture and its views
 
-			switch (info.textureType) {
+	static void glxTextureBaseLevel(TextureObject::Data *data, u8 baseLevel) {
 
-				case TextureType::TEXTURE_1D:
+		if (data->baseLevel == baseLevel)
+			return;
 
-					glTextureSubImage1D(
+		data->baseLevel = baseLevel;
 
-						handle,
+		for (auto &view : data->textureViews)
+			glTextureParameteri(view.second, GL_TEXTURE_BASE_LEVEL, TextureObject::Data::viewBaseLevel(view.first, baseLevel));
+	}
 
-						pending.mip,
+	void Texture::flush(CommandList::Data*, UploadBuffer *uploadBuffer, const Pair<u64, u64> &allocation) {
 
-						pending.start.x,
-						pending.size.x, 
+		//Dropped mips aren't sampled anymore; their contents can be discarded by the driver
 
-						format,
-						type,
-						src
-					);
+		if (info.isStreaming && residentMip < targetMip) {
 
-					break;
+			glxTextureBaseLevel(data, targetMip);
 
-				case TextureType::TEXTURE_1D_ARRAY:
-				case TextureType::TEXTURE_2D:
+			for (u8 m = residentMip; m < targetMip; ++m)
+				glInvalidateTexImage(data->handle, m);
 
-					glTextureSubImage2D(
+			residentMip = targetMip;
+		}
 
-						handle,
-						
-						pending.mip,
+		u8 streamMip = getStreamMip();
 
-						pending.start.x,
-						pending.start.y,
+		if (info.pending.empty() && streamMip >= residentMip)
+			return;
 
-						pending.size.x,
-						pending.size.y,
+		if (!HasFlags(info.usage, GPUMemoryUsage::SHARED) && !uploadBuffer) {
+			oic::System::log()->error("Even though OpenGL handles UploadBuffers implictly, for non shared memory one is required by the ignis spec");
+			return;
+		}
 
-						format,
-						type,
-						src
-					);
+		if (info.files.empty() && !info.hasData())
+			oic::System::log()->error("Texture didn't have any backing CPU data");
 
-					break;
+		GLuint handle = data->handle;
+		bool isCompressed = FormatHelper::isCompressed(info.format);
 
-				default:
+		GLenum type = isCompressed ? GLenum{} : glxGpuFormatType(info.format);
+		GLenum format = isCompressed ? glxColorFormat(info.format) : glxGpuDataFormat(info.format);
 
-					glTextureSubImage3D(
+		//Source from the upload buffer if it was staged in prepare
 
-						handle,
-						
-						pending.mip,
+		GPUBuffer *staging{};
 
-						pending.start.x,
-						pending.start.y,
-						pending.start.z,
+		if (allocation.second != u64_MAX && uploadBuffer) {
 
-						pending.size.x,
-						pending.size.y,
-						pending.size.z,
+			auto &buffers = uploadBuffer->getInfo().buffers;
+			auto it = buffers.find(allocation.first);
 
-						format,
-						type,
-						src
-					);
+			if (it == buffers.end()) {
+				oic::System::log()->error("Texture staging buffer isn't found in the upload buffer");
+				return;
 			}
+
+			staging = it->second;
 		}
 
+		List<MappedFile> mapped;
+		auto uploads = glxTextureUploads(*this, streamMip, staging ? nullptr : &mapped);
+
+		if (staging)
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging->getExtendedData()->handle);
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		//Compressed rows are addressed in blocks
+
+		if (isCompressed) {
+			glPixelStorei(GL_UNPACK_COMPRESSED_BLOCK_WIDTH, GLint(FormatHelper::getBlockWidth(info.format)));
+			glPixelStorei(GL_UNPACK_COMPRESSED_BLOCK_HEIGHT, GLint(FormatHelper::getBlockHeight(info.format)));
+			glPixelStorei(GL_UNPACK_COMPRESSED_BLOCK_DEPTH, 1);
+			glPixelStorei(GL_UNPACK_COMPRESSED_BLOCK_SIZE, GLint(FormatHelper::getBlockBytes(info.format)));
+		}
+
+		u64 offset = allocation.second;
+		Buffer converted;
+
+		for (auto &upload : uploads) {
+
+			const void *src = staging ? (const void*)usz(offset) : upload.src;
+
+			if (staging)
+				offset += upload.stagedSize;
+
+			if (!src && !staging) {
+				oic::System::log()->error("Texture upload couldn't be read");
+				continue;
+			}
+
+			//Client memory has to be converted here if it wasn't staged
+
+			if (!staging && info.needsConversion()) {
+
+				converted.resize(upload.size);
+
+				if (!FormatConverter::convert(
+					info.getDataFormat(), upload.src, info.format, converted.data(),
+					usz(upload.srcSize / FormatHelper::getSizeBytes(info.getDataFormat())), info.swapRB
+				))
+					continue;
+
+				src = converted.data();
+			}
+
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, staging ? upload.stagedRowLength : upload.rowLength);
+			glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, staging ? upload.stagedImageHeight : upload.imageHeight);
+
+			if (isCompressed)
+				glxCompressedTextureSubImage(
+					handle, info.textureType, upload.mip, upload.start, upload.dim, format, GLsizei(upload.imageSize), src
+				);
+
+			else glxTextureSubImage(handle, info.textureType, upload.mip, upload.start, upload.dim, format, type, src);
+		}
+
+		//Restore the default unpack state
+
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		if (isCompressed) {
+			glPixelStorei(GL_UNPACK_COMPRESSED_BLOCK_WIDTH, 0);
+			glPixelStorei(GL_UNPACK_COMPRESSED_BLOCK_HEIGHT, 0);
+			glPixelStorei(GL_UNPACK_COMPRESSED_BLOCK_DEPTH, 0);
+			glPixelStorei(GL_UNPACK_COMPRESSED_BLOCK_SIZE, 0);
+		}
+
+		if (staging)
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
 		info.pending.clear();
+		info.markedPending = false;
 
-		//First flush is only for submitting the initial texture. Then the data is removed
-		if (!HasFlags(info.usage, GPUMemoryUsage::CPU_WRITE)) {
-			info.initData.clear();
+		//Streamed mips can be sampled now; the source is kept for mips that are dropped
+
+		if (info.isStreaming) {
+			residentMip = std::min(residentMip, streamMip);
+			glxTextureBaseLevel(data, residentMip);
 			return;
 		}
+
+		info.files.clear();
+
+		//First flush is only for submitting the initial texture. Then the data is removed
+		if (!HasFlags(info.usage, GPUMemoryUsage::CPU_WRITE))
+			info.initData.clear();
 	}
 
-}
\ No newline at end of file
+}
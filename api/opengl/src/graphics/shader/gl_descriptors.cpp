@@ -1,19 +1,56 @@
-#include "graphics/shader/descriptors.hpp"
+#include "graphics/shader/gl_descriptors.hpp"
+#include "graphics/memory/gpu_buffer.hpp"
+#include "graphics/memory/texture_object.hpp"
+#include "graphics/shader/sampler.hpp"
+#include "graphics/gl_header.hpp"
 #include "system/system.hpp"
 #include "system/log.hpp"
 
 namespace ignis {
 
-	//Since descriptors are a Vulkan/DX12 concept, these don't maintain API data (flush doesn't do anything)
+	//Since descriptors are a Vulkan/DX12 concept, these don't maintain API data besides the resolved bindings
 	//They are instead bound runtime
 
+	static void glxResolveBindings(const Descriptors::Info &info, Descriptors::Data *data) {
+
+		data->bindings.clear();
+		data->bindings.reserve(info.flushedResources.size());
+
+		for (auto &mapIt : info.pipelineLayout->getInfo()) {
+
+			auto it = info.flushedResources.find(mapIt.first);
+
+			if (it == info.flushedResources.end())
+				continue;
+
+			auto &subres = it->second;
+			auto *res = subres.resource;
+
+			Descriptors::Data::Binding binding{ &mapIt.second, subres };
+
+			binding.buffer = dynamic_cast<GPUBuffer*>(res);
+			binding.sampler = dynamic_cast<Sampler*>(res);
+			binding.texture = binding.sampler ? subres.samplerData.texture : dynamic_cast<TextureObject*>(res);
+
+			if (binding.texture)
+				binding.textureView = glxTextureView(binding.texture, subres, binding.viewGeneration);
+
+			data->bindings.push_back(binding);
+		}
+	}
+
 	Descriptors::Descriptors(Graphics &g, const String &name, const Info &inf) :
 		GPUObject(g, name, GPUObjectType::DESCRIPTORS), info(inf)
 	{
 		info.flushedResources = inf.resources;
+
+		data = new Data();
+		glxResolveBindings(info, data);
 	}
 
-	Descriptors::~Descriptors() {}
+	Descriptors::~Descriptors() {
+		destroy(data);
+	}
 
 	//TODO: Make this a GPU concept like FlushBuffer and FlushImage
 	//TODO: Keep refCount
@@ -32,6 +69,9 @@ namespace ignis {
 					oic::System::log()->fatal("Descriptors::flush out of bounds");
 			}
 
+		//Texture views are created here rather than when binding
+
+		glxResolveBindings(info, data);
 	}
 
 	void Descriptors::updateDescriptor(u32 i, const GPUSubresource &range) {
@@ -42,4 +82,4 @@ namespace ignis {
 		info.resources[i] = range;
 	}
 
-}
\ No newline at end of file
+}
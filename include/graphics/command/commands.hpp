@@ -292,6 +292,85 @@ namespace ignis {
 			List<GPUObject*> getResources() const final override { return { texture }; }
 		};
 
+		//Regenerates every mip of the texture from the first mip (e.g. after a dispatch or render pass wrote into it)
+		//Float and normalized 2D (array) and cube textures are downsampled by a compute shader;
+		//BOX writes up to 5 mips per dispatch through shared memory, other filters a dispatch per mip.
+		//Other textures (and sRGB) fall back to the driver's mip generation
+		class GenerateMips : Command {
+
+			TextureRef texture;
+			MipFilter filter;
+
+			apimpl void execute(Graphics&, CommandList::Data*) const final override;
+
+		public:
+
+			GenerateMips(Texture *texture, MipFilter filter = MipFilter::BOX):
+				texture(texture), filter(filter) {}
+
+			List<GPUObject*> getResources() const final override { return { texture }; }
+		};
+
+		//Converts the planes of a YUV frame (see VideoFormat) into a GPU writable RGB(A) texture of the same size
+		//Chroma is interpolated bilinearly; r16 planes are treated as 10 bit samples in the high bits (P010)
+		class ConvertYUV : Command {
+
+			TextureRef output, luma, u, v;
+			YUVMatrix matrix;
+			YUVRange range;
+			YUVChromaSiting siting;
+
+			apimpl void execute(Graphics&, CommandList::Data*) const final override;
+
+		public:
+
+			//Interleaved chroma (NV12, P010)
+			ConvertYUV(
+				Texture *output, Texture *luma, Texture *chroma,
+				YUVMatrix matrix = YUVMatrix::BT709, YUVRange range = YUVRange::LIMITED,
+				YUVChromaSiting siting = YUVChromaSiting::LEFT
+			):
+				output(output), luma(luma), u(chroma), matrix(matrix), range(range), siting(siting) {}
+
+			//Separate chroma planes (I420)
+			ConvertYUV(
+				Texture *output, Texture *luma, Texture *u, Texture *v,
+				YUVMatrix matrix = YUVMatrix::BT709, YUVRange range = YUVRange::LIMITED,
+				YUVChromaSiting siting = YUVChromaSiting::LEFT
+			):
+				output(output), luma(luma), u(u), v(v), matrix(matrix), range(range), siting(siting) {}
+
+			List<GPUObject*> getResources() const final override { return { output, luma, u, v }; }
+		};
+
+		//Encodes an RGB(A) texture (e.g. a render texture) into an 8 bit NV12 frame in a GPU writable buffer
+		//(luma, then interleaved chroma). Width has to be a multiple of 4 and height a multiple of 2;
+		//the frame can be read with ReadbackBuffer. sRGB textures are encoded from their non linear values
+		class EncodeNV12 : Command {
+
+			GraphicsObjectRef<TextureObject> input;
+			GPUBufferRef output;
+			u64 offset;
+
+			YUVMatrix matrix;
+			YUVRange range;
+			YUVChromaSiting siting;
+
+			apimpl void execute(Graphics&, CommandList::Data*) const final override;
+
+		public:
+
+			//offset has to be aligned to the storage buffer offset alignment (256 is always safe)
+			EncodeNV12(
+				TextureObject *input, GPUBuffer *output, u64 offset = 0,
+				YUVMatrix matrix = YUVMatrix::BT709, YUVRange range = YUVRange::LIMITED,
+				YUVChromaSiting siting = YUVChromaSiting::LEFT
+			):
+				input(input), output(output), offset(offset), matrix(matrix), range(range), siting(siting) {}
+
+			List<GPUObject*> getResources() const final override { return { input, output }; }
+		};
+
 		//Clears buffer to zero
 		class ClearBuffer : Command {
 
@@ -356,6 +435,111 @@ namespace ignis {
 
 			List<GPUObject*> getResources() const final override { return { image, uploadBuffer }; }
 		};
+
+		//Copies texels from CPU memory into regions of a texture through the upload buffer
+		//For textures without a CPU copy (e.g. the tile cache of a VirtualTexture).
+		//The queue is emptied when it's staged, so the command can be recorded once and reused
+		class UploadImage : Command {
+
+		public:
+
+			//Regions and their offset into data; rows (of blocks) are tightly packed
+			struct Queue {
+				Buffer data;
+				List<Pair<TextureRange, u64>> regions;
+			};
+
+		private:
+
+			TextureRef image;
+			UploadBufferRef uploadBuffer;
+			Queue *queue;
+
+			List<Pair<TextureRange, u64>> staged;
+			Pair<u64, u64> allocation;
+
+			apimpl void prepare(Graphics&, CommandList::Data*) final override;
+			apimpl void execute(Graphics&, CommandList::Data*) const final override;
+
+		public:
+
+			UploadImage(Texture *tex, UploadBuffer *uploadBuffer, Queue *queue):
+				image(tex), uploadBuffer(uploadBuffer), queue(queue), allocation{ 0, u64_MAX } {}
+
+			List<GPUObject*> getResources() const final override { return { image, uploadBuffer }; }
+		};
+
+		//Marks the pages of a virtual texture that are requested in the feedback buffer (one bit per page)
+		//requests is a float texture of (u, v, mip, coverage) per texel, e.g. rendered at a fraction of the resolution;
+		//texels with a coverage of 0 are skipped. pages is the number of pages of the first mip
+		class VirtualTextureFeedback : Command {
+
+			GraphicsObjectRef<TextureObject> requests;
+			GPUBufferRef feedback;
+
+			Vec2u32 pages;
+			u8 mips;
+
+			apimpl void execute(Graphics&, CommandList::Data*) const final override;
+
+		public:
+
+			VirtualTextureFeedback(TextureObject *requests, GPUBuffer *feedback, const Vec2u32 &pages, u8 mips):
+				requests(requests), feedback(feedback), pages(pages), mips(mips) {}
+
+			List<GPUObject*> getResources() const final override { return { requests, feedback }; }
+		};
+
+		//Copy a GPUBuffer range into an UploadBuffer once the execution is done
+		//The callback is called when the fence of the execution is reached (updateContext or wait)
+		//data is a view into the upload buffer and is only valid during the callback
+		class ReadbackBuffer : Command {
+
+		public:
+
+			using Callback = void (*)(void *instance, GPUBuffer *buffer, const u8 *data, u64 offset, u64 size);
+
+		private:
+
+			GPUBufferRef buffer;
+			UploadBufferRef uploadBuffer;
+
+			void *instance;
+			Callback callback;
+
+			u64 offset, size;
+			u64 length{};			//Resolved size (prepare)
+
+			Pair<u64, u64> allocation;
+
+			template<typename T, void (T::*func)(GPUBuffer*, const u8*, u64, u64)>
+			static void callMember(void *instance, GPUBuffer *buffer, const u8 *data, u64 offset, u64 size) {
+				(((T*)instance)->*func)(buffer, data, offset, size);
+			}
+
+			apimpl void prepare(Graphics&, CommandList::Data*) final override;
+			apimpl void execute(Graphics&, CommandList::Data*) const final override;
+
+		public:
+
+			//size of 0 reads until the end of the buffer
+			ReadbackBuffer(
+				GPUBuffer *buffer, UploadBuffer *uploadBuffer, void *instance, Callback callback, 
+				u64 offset = 0, u64 size = 0
+			):
+				buffer(buffer), uploadBuffer(uploadBuffer), instance(instance), callback(callback),
+				offset(offset), size(size) {}
+
+			//Readback into a member function
+			template<typename T, void (T::*func)(GPUBuffer*, const u8*, u64, u64)>
+			static inline ReadbackBuffer create(
+				GPUBuffer *buffer, UploadBuffer *uploadBuffer, T *instance, u64 offset = 0, u64 size = 0
+			) {
+				return ReadbackBuffer(buffer, uploadBuffer, instance, &callMember<T, func>, offset, size);
+			}
+
+			List<GPUObject*> getResources() const final override { return { buffer, uploadBuffer }; }
+		};
 		
 		//Debug calls
 
@@ -86,7 +86,12 @@ namespace ignis {
 		GPU_WRITE_ONLY		= 0x14,	
 		CPU_READ			= 0x20,
 
-		ALL					= 0x3F,
+		//Ring of CPU_WRITE | SHARED regions that the CPU writes into directly (no CPU copy)
+		//Every flush publishes the current region and moves writes to the next one
+		DYNAMIC				= 0x40,
+		GPU_DYNAMIC			= DYNAMIC | CPU_WRITE | SHARED,
+
+		ALL					= 0x7F,
 
 		FORCE_LINEAR_TILING	= CPU_WRITE | REQUIRE | SHARED		//Incompatible with the 'prefer' flag
 	};
@@ -241,6 +246,57 @@ namespace ignis {
 
 	enumFlagOverloads(TextureType);
 
+	//Filter used when generating mips
+	enum class MipFilter : u8 {
+		BOX,			//Average of the covered texels
+		TRIANGLE,		//Linear falloff; smoother than box
+		KAISER			//Kaiser windowed sinc; sharpest, but might ring
+	};
+
+	//Multi planar video frames; planes are regular textures, chroma is at half the resolution
+	//Frames are stored plane after plane, tightly packed
+	enum class VideoFormat : u8 {
+		NV12,			//r8 luma, rg8 interleaved chroma
+		I420,			//r8 luma, r8 u, r8 v
+		P010			//r16 luma, rg16 interleaved chroma; 10 bit samples in the high bits
+	};
+
+	//Colour matrix of YUV video
+	enum class YUVMatrix : u8 {
+		BT601,
+		BT709,
+		BT2020
+	};
+
+	//Limited is 16-235 for luma and 16-240 for chroma (scaled for 10 bit); full uses every value
+	enum class YUVRange : u8 {
+		LIMITED,
+		FULL
+	};
+
+	//Position of the chroma samples of 4:2:0 frames; LEFT (MPEG-2, H.264, HEVC) is on the even luma columns,
+	//CENTER (MPEG-1, JPEG) in the middle of 2x2 luma samples. Both are vertically in the middle of two rows
+	enum class YUVChromaSiting : u8 {
+		LEFT,
+		CENTER
+	};
+
+	//Speed versus quality of the CPU block compression
+	enum class CompressionQuality : u8 {
+		FAST,			//Bounding box endpoints
+		NORMAL,			//Principal axis endpoints
+		HIGH			//Principal axis with least squares refinement
+	};
+
+	//How f32 vertex attributes are stored by the VertexQuantizer
+	//16 bit formats pad r to rg (y = 0) and rgb to rgba (w = 1), so attributes stay 4 byte aligned
+	enum class VertexQuantization : u8 {
+		NONE,			//Copied as is
+		HALF,			//16 bit floats
+		UNORM16,		//Normalized to the bounds of the attribute in the mesh (positions, uvs)
+		OCTAHEDRAL		//Unit vectors; xyz to octahedral rg16s (normals), xyz + w sign to rgb10a2s (tangents)
+	};
+
 	//& 0x03 = dimension (CUBE, 1D, 2D, 3D)
 	//& 0x04 = isMultisampled
 	//& 0x08 = isArray
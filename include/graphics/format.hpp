@@ -43,6 +43,8 @@ namespace ignis {
 	//& 0x40			= isFloatingPoint
 	//& 0x100			= isSRGB
 	//& 0x200			= isNone
+	//& 0x800			= isCompressed; & 0xF0 is the family (BC, ETC2/EAC, ASTC) and & 0xF the format
+	//& 0x1000			= isPacked; & 0xF is the format, channels share one 32 bit (16 for rgb565) element
 	oicExposedEnum(GPUFormat, u16,
 
 		r8 = 0x00,		rg8,	rgba8 = 0x03,
@@ -67,6 +69,24 @@ namespace ignis {
 
 		srgba8 = 0x103,
 
+		bc1 = 0x800,	bc2,	bc3,	bc4,	bc4s,
+		bc5,			bc5s,	bc6h,	bc6hs,	bc7,
+
+		etc2 = 0x810,	etc2a1,	etc2a8,
+		eacr11,			eacr11s,	eacrg11,	eacrg11s,
+
+		astc4x4 = 0x820,	astc5x5,	astc6x6,	astc8x8,	astc10x10,	astc12x12,
+
+		bc1srgb = 0x900,	bc2srgb,	bc3srgb,	bc7srgb = 0x909,
+		etc2srgb = 0x910,	etc2a1srgb,	etc2a8srgb,
+
+		astc4x4srgb = 0x920,	astc5x5srgb,	astc6x6srgb,	astc8x8srgb,	astc10x10srgb,	astc12x12srgb,
+
+		//r in the low bits (2_10_10_10_REV), except rgb565 (r in the high bits)
+		//rgb10a2s is only supported as vertex attribute (e.g. normals)
+
+		rgb10a2 = 0x1000,	rgb10a2u,	rgb10a2s,	r11g11b10f,	rgb9e5,	rgb565,
+
 		NONE = 0x200
 	);
 
@@ -104,23 +124,61 @@ namespace ignis {
 		static constexpr usz getChannelCount(GPUFormat gf);
 		static constexpr usz getSizeBits(GPUFormat gf);
 		static constexpr usz getSizeBytes(GPUFormat gf);
+
+		//Packed formats store every channel in one element; their stride is the element
+
+		static constexpr bool isPacked(GPUFormat gf);
+
+		//Block compression; uncompressed formats have 1x1 blocks of getSizeBytes
+
+		static constexpr bool isCompressed(GPUFormat gf);
+		static constexpr usz getBlockWidth(GPUFormat gf);
+		static constexpr usz getBlockHeight(GPUFormat gf);
+		static constexpr usz getBlockBytes(GPUFormat gf);
+
+		//Bytes used by x * y * z texels (rounded up to whole blocks)
+		static constexpr usz getImageBytes(GPUFormat gf, usz x, usz y = 1, usz z = 1);
 	};
 
 	constexpr bool FormatHelper::isFloatingPoint(DepthFormat df) { return u8(df) & 0x10; }
-	constexpr bool FormatHelper::isFloatingPoint(GPUFormat gf) { return u8(gf.value) & 0x40; }
+	constexpr bool FormatHelper::isFloatingPoint(GPUFormat gf) { return isCompressed(gf) || isPacked(gf) ? isFloatingPoint(getType(gf)) : u8(gf.value) & 0x40; }
 	constexpr bool FormatHelper::isFloatingPoint(GPUFormatType gft) { return u8(gft) & 0x4; }
 
 	constexpr bool FormatHelper::hasStencil(DepthFormat df) { return u8(df) & 0x1; }
-	constexpr bool FormatHelper::isSigned(GPUFormat gf) { return u8(gf.value) & 0x10; }
+	constexpr bool FormatHelper::isSigned(GPUFormat gf) { return isCompressed(gf) || isPacked(gf) ? isSigned(getType(gf)) : u8(gf.value) & 0x10; }
 	constexpr bool FormatHelper::isSigned(GPUFormatType gft) { return u8(gft) & 0x1; }
 
 	constexpr bool FormatHelper::isAuto(DepthFormat df) { return u8(df) & 0x20; }
-	constexpr bool FormatHelper::isUnnormalized(GPUFormat gf) { return u8(gf.value) & 0x20; }
+	constexpr bool FormatHelper::isUnnormalized(GPUFormat gf) { return isCompressed(gf) || isPacked(gf) ? isUnnormalized(getType(gf)) : u8(gf.value) & 0x20; }
 	constexpr bool FormatHelper::isUnnormalized(GPUFormatType gft) { return u8(gft) & 0x2; }
 
 	constexpr bool FormatHelper::isNone(DepthFormat df) { return u8(df) & 0x40; }
 	constexpr bool FormatHelper::isNone(GPUFormat gf) { return u16(gf.value) & 0x400; }
-	constexpr GPUFormatType FormatHelper::getType(GPUFormat gf) { return GPUFormatType(u8(gf.value) >> 4); }
+
+	constexpr GPUFormatType FormatHelper::getType(GPUFormat gf) {
+
+		if (!isCompressed(gf) && !isPacked(gf))
+			return GPUFormatType(u8(gf.value) >> 4);
+
+		switch (gf.value) {
+
+			case GPUFormat::rgb10a2u:
+				return GPUFormatType::UINT;
+
+			case GPUFormat::rgb10a2s:
+
+			case GPUFormat::bc4s:	case GPUFormat::bc5s:
+			case GPUFormat::eacr11s:	case GPUFormat::eacrg11s:
+				return GPUFormatType::SNORM;
+
+			case GPUFormat::bc6h:	case GPUFormat::bc6hs:
+			case GPUFormat::r11g11b10f:	case GPUFormat::rgb9e5:
+				return GPUFormatType::FLOAT;
+
+			default:
+				return GPUFormatType::UNORM;
+		}
+	}
 
 	constexpr usz FormatHelper::getDepthBits(DepthFormat df) { return df == DepthFormat::NONE ? 0 : 16_usz + (usz(u8(df) & 0x6) << 2); }
 	constexpr usz FormatHelper::getDepthBytes(DepthFormat df) { return df == DepthFormat::NONE ? 0 : 2_usz + (usz(u8(df) & 0x6) >> 1); }
@@ -133,11 +191,88 @@ namespace ignis {
 	constexpr bool FormatHelper::isInt(GPUFormat gf) { return isUnnormalized(gf) && !isFloatingPoint(gf); }
 	constexpr bool FormatHelper::isInt(GPUFormatType gft) { return isUnnormalized(gft) && !isFloatingPoint(gft); }
 
-	constexpr usz FormatHelper::getStrideBits(GPUFormat gf) { return 8_usz << ((u8(gf.value) >> 2) & 3); }
-	constexpr usz FormatHelper::getStrideBytes(GPUFormat gf) { return 1_usz << ((u8(gf.value) >> 2) & 3); }
-	constexpr usz FormatHelper::getChannelCount(GPUFormat gf) { return 1_usz + (u8(gf.value) & 3); }
-	constexpr usz FormatHelper::getSizeBits(GPUFormat gf) { return getStrideBits(gf) * getChannelCount(gf); }
-	constexpr usz FormatHelper::getSizeBytes(GPUFormat gf) { return getStrideBytes(gf) * getChannelCount(gf); }
+	constexpr usz FormatHelper::getStrideBits(GPUFormat gf) { return getStrideBytes(gf) << 3; }
+
+	constexpr usz FormatHelper::getStrideBytes(GPUFormat gf) {
+
+		if (isPacked(gf))
+			return gf == GPUFormat::rgb565 ? 2 : 4;
+
+		return 1_usz << ((u8(gf.value) >> 2) & 3);
+	}
+
+	constexpr usz FormatHelper::getChannelCount(GPUFormat gf) {
+
+		if (isPacked(gf))
+			return gf.value <= GPUFormat::rgb10a2s ? 4 : 3;
+
+		if (!isCompressed(gf))
+			return 1_usz + (u8(gf.value) & 3);
+
+		switch (gf.value) {
+
+			case GPUFormat::bc4:		case GPUFormat::bc4s:
+			case GPUFormat::eacr11:		case GPUFormat::eacr11s:
+				return 1;
+
+			case GPUFormat::bc5:		case GPUFormat::bc5s:
+			case GPUFormat::eacrg11:	case GPUFormat::eacrg11s:
+				return 2;
+
+			case GPUFormat::bc6h:		case GPUFormat::bc6hs:
+			case GPUFormat::etc2:		case GPUFormat::etc2srgb:
+				return 3;
+
+			default:
+				return 4;
+		}
+	}
+
+	constexpr usz FormatHelper::getSizeBits(GPUFormat gf) { return getSizeBytes(gf) << 3; }
+	constexpr usz FormatHelper::getSizeBytes(GPUFormat gf) { return getStrideBytes(gf) * (isPacked(gf) ? 1 : getChannelCount(gf)); }
+
+	constexpr bool FormatHelper::isPacked(GPUFormat gf) { return u16(gf.value) & 0x1000; }
+	constexpr bool FormatHelper::isCompressed(GPUFormat gf) { return u16(gf.value) & 0x800; }
+
+	constexpr usz FormatHelper::getBlockWidth(GPUFormat gf) {
+
+		if (!isCompressed(gf))
+			return 1;
+
+		if ((u16(gf.value) & 0xF0) != 0x20)		//BC and ETC2/EAC
+			return 4;
+
+		constexpr usz astcSizes[] = { 4, 5, 6, 8, 10, 12 };
+		return astcSizes[u16(gf.value) & 0xF];
+	}
+
+	constexpr usz FormatHelper::getBlockHeight(GPUFormat gf) { return getBlockWidth(gf); }
+
+	constexpr usz FormatHelper::getBlockBytes(GPUFormat gf) {
+
+		if (!isCompressed(gf))
+			return getSizeBytes(gf);
+
+		switch (gf.value) {
+
+			case GPUFormat::bc1:		case GPUFormat::bc1srgb:
+			case GPUFormat::bc4:		case GPUFormat::bc4s:
+			case GPUFormat::etc2:		case GPUFormat::etc2srgb:
+			case GPUFormat::etc2a1:		case GPUFormat::etc2a1srgb:
+			case GPUFormat::eacr11:		case GPUFormat::eacr11s:
+				return 8;
+
+			default:
+				return 16;
+		}
+	}
+
+	constexpr usz FormatHelper::getImageBytes(GPUFormat gf, usz x, usz y, usz z) {
+
+		const usz bw = getBlockWidth(gf), bh = getBlockHeight(gf);
+
+		return ((x + bw - 1) / bw) * ((y + bh - 1) / bh) * z * getBlockBytes(gf);
+	}
 }
 
 oicEnumHash(ignis::GPUFormat);
\ No newline at end of file
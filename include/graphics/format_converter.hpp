@@ -0,0 +1,33 @@
+#pragma once
+#include "graphics/format.hpp"
+
+namespace ignis {
+
+	//Converts texels between uncompressed GPUFormats on the CPU
+	//Normalized and floating point formats convert between each other (through linear floats if there's no faster path);
+	//integer formats only convert between formats of the same type and stride (swizzle or channel count)
+	//and packed formats are only copied.
+	//Missing channels are set to 0 and missing alpha to 1; srgba8 is converted to and from linear space
+	struct FormatConverter {
+
+		static bool canConvert(GPUFormat src, GPUFormat dst);
+
+		//Convert texels from src into dst; swapRB swaps the red and blue channels of the source (BGR(A) data)
+		//Large conversions are split over multiple threads
+		static bool convert(GPUFormat srcFormat, const u8 *src, GPUFormat dstFormat, u8 *dst, usz texels, bool swapRB = false);
+
+		//Size of srcBytes of src texels once converted to dst
+		static inline usz getConvertedBytes(GPUFormat src, GPUFormat dst, usz srcBytes) {
+			return srcBytes / FormatHelper::getSizeBytes(src) * FormatHelper::getSizeBytes(dst);
+		}
+
+		//Normalized or floating point texels to linear floats and back (with the channel count of the format)
+		static void decode(GPUFormat format, const u8 *src, f32 *dst, usz texels);
+		static void encode(GPUFormat format, const f32 *src, u8 *dst, usz texels);
+
+		//Half floats; uses F16C if it's available
+		static void halfToFloat(const u16 *src, f32 *dst, usz count);
+		static void floatToHalf(const f32 *src, u16 *dst, usz count);
+	};
+
+}
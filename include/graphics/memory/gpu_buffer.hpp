@@ -1,6 +1,7 @@
 #pragma once
 #include "graphics/gpu_resource.hpp"
 #include "graphics/command/command_list.hpp"
+#include "graphics/memory/mapped_file.hpp"
 #include "types/vec.hpp"
 
 namespace ignis {
@@ -23,6 +24,7 @@ namespace ignis {
 		struct Info {
 
 			Buffer initData;
+			FileRegion file;		//If non empty; init data is loaded from the file when it's needed
 			u64 size;
 
 			GPUBufferUsage type;
@@ -31,8 +33,27 @@ namespace ignis {
 			List<Vec2u64> pending;	//offset, size
 			bool markedPending{};
 
-			Info(u64 bufferSize, GPUBufferUsage type, GPUMemoryUsage usage);
-			Info(GPUBufferUsage type, GPUMemoryUsage usage, const Buffer &initData);
+			u8 regions = 1;			//Ring regions of size 'size'; 1 unless DYNAMIC
+
+			static constexpr u8 defaultDynamicRegions = 3;
+
+			//DYNAMIC buffers are allocated dynamicRegions times; the CPU writes into one while the GPU reads the others
+			//dynamicRegions is ignored for other buffers
+			Info(u64 bufferSize, GPUBufferUsage type, GPUMemoryUsage usage, u8 dynamicRegions = defaultDynamicRegions);
+			Info(GPUBufferUsage type, GPUMemoryUsage usage, const Buffer &initData, u8 dynamicRegions = defaultDynamicRegions);
+
+			//Initialize from a file region; a size of 0 uses the rest of the file
+			//Buffers without CPU_WRITE stream the file into the upload buffer without loading it into memory
+			Info(GPUBufferUsage type, GPUMemoryUsage usage, const FileRegion &file, u8 dynamicRegions = defaultDynamicRegions);
+
+			//STAGING buffers in SHARED memory with CPU_WRITE are written through their persistent mapping,
+			//so they don't keep a CPU copy
+			bool isMappedStaging() const;
+
+		private:
+
+			//Returns false if the buffer isn't DYNAMIC
+			bool initDynamic(u8 dynamicRegions);
 		};
 
 		apimpl struct Data;
@@ -45,18 +66,37 @@ namespace ignis {
 		bool isCompatible(const RegisterLayout &reg, const GPUSubresource &resource) const final override;
 
 		inline u64 size() const { return info.size; }
+		inline u64 getCapacity() const { return capacity; }
+
+		bool isDynamic() const;
+
+		//Offset of the region that the GPU will read (only non zero for DYNAMIC)
+		inline u64 getRegionOffset() const { return regionOffset; }
 
 		Data *getExtendedData() { return data; }
 		const Info &getInfo() const { return info; }
 
+		//DYNAMIC buffers return the mapped region that will be published on the next flush
+		//The first call after a flush waits until the GPU is done reading that region
+		//Mapped staging buffers return the mapping; writes are made visible by flush(offset, size)
 		template<typename T = u8>
-		T *getBuffer() const { return (T*) info.initData.data(); }
+		T *getBuffer() const { 
+			return (T*) (dynamicRegion ? acquireDynamic() : (mappedStaging ? mappedStaging : info.initData.data()));
+		}
 
 		void flush(u64 offset, u64 size);
 
+		//Resize the buffer; the contents up to the smallest size are kept
+		//Capacity grows by 1.5x and only shrinks (to 2x the size) when less than 1/4th is used
+		//Storage is moved on the GPU and dependent bindings are patched on the next execution
+		void resize(u64 size);
+
 		//Only valid if the GPU memory is present on the CPU (e.g. it's shared memory)
 		apimpl Buffer readback(u64 offset, u64 size);
 
+		//Same as readback, but without copying; the view is invalidated when the memory is reused
+		apimpl const u8 *readbackView(u64 offset, u64 size) const;
+
 	protected:
 
 		void mergePending();
@@ -70,12 +110,26 @@ namespace ignis {
 		//Copy allocation from GPU to CPU
 		apimpl void flush(CommandList::Data*, UploadBuffer*, const Pair<u64, u64>&);
 
+		//Publish the DYNAMIC write region and move to the next; only once per execution
+		apimpl void flushDynamic();
+
+		//Wait for the last execution that could read the DYNAMIC write region
+		apimpl u8 *acquireDynamic() const;
+
+		//Move the storage to a new allocation, copying the first copySize bytes
+		apimpl void reallocate(u64 capacity, u64 copySize);
+
 		apimpl ~GPUBuffer();
 
 	private:
 
 		Info info;
 		Data *data;
+
+		u8 *dynamicRegion{}, *mappedStaging{};
+		u64 regionOffset{};
+
+		u64 capacity{};
 	};
 
 	using GPUBufferRef = GraphicsObjectRef<GPUBuffer>;
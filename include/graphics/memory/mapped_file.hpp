@@ -0,0 +1,60 @@
+#pragma once
+#include "types/types.hpp"
+
+namespace ignis {
+
+	//A region of a file on disk (native path)
+	//Resources can be initialized from this without loading the file into memory first
+	struct FileRegion {
+
+		String path;
+		u64 offset{}, size{};
+
+		inline bool empty() const { return path.empty(); }
+	};
+
+	//A read only view of a file; pages are loaded by the OS when they're accessed
+	class MappedFile {
+
+	public:
+
+		MappedFile() = default;
+		MappedFile(const String &path);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile &operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile &&other) noexcept;
+		MappedFile &operator=(MappedFile &&other) noexcept;
+
+		inline const u8 *data() const { return ptr; }
+		inline u64 size() const { return length; }
+		inline bool isValid() const { return ptr; }
+
+		//Pointer to the region; nullptr if it's out of bounds
+		const u8 *get(u64 offset, u64 size) const;
+
+		//Pointer to the region of the file; nullptr if it's out of bounds or it's another file
+		inline const u8 *get(const FileRegion &region) const { 
+			return region.path == path ? get(region.offset, region.size) : nullptr;
+		}
+
+		inline const String &getPath() const { return path; }
+
+		//Get the region from a list of opened files; the file is opened if it isn't in the list yet
+		static const u8 *get(List<MappedFile> &files, const FileRegion &region);
+
+	private:
+
+		void release();
+
+		String path;
+
+		const u8 *ptr{};
+		u64 length{};
+
+		void *file{}, *mapping{};
+	};
+
+}
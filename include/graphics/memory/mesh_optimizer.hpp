@@ -0,0 +1,31 @@
+#pragma once
+#include "graphics/memory/buffer_layout.hpp"
+
+namespace ignis {
+
+	//Reorders indexed triangle lists for the GPU's vertex caches
+	//ACMR (average cache miss ratio) is the number of transformed vertices per triangle;
+	//0.5 is the best case for regular grids and 3 the worst (no reuse)
+	struct MeshOptimizer {
+
+		struct Stats {
+			f32 acmrBefore, acmrAfter;
+		};
+
+		//Size of the simulated FIFO cache used for the ACMR
+		static constexpr u32 defaultCacheSize = 16;
+
+		//Reorder triangles for post transform cache hits (Tom Forsyth's linear speed vertex cache optimisation)
+		static void optimizeCache(u32 *indices, usz indexCount, u32 vertexCount);
+
+		//Number vertices in order of first use, so fetches are mostly sequential
+		//Returns the new position of every vertex (unused vertices are moved to the end)
+		static List<u32> optimizeFetch(u32 *indices, usz indexCount, u32 vertexCount);
+
+		//Move the vertices (of stride bytes) of data to the new positions returned by optimizeFetch
+		static void remapVertices(Buffer &data, usz stride, const List<u32> &remap);
+
+		static f32 getACMR(const u32 *indices, usz indexCount, u32 vertexCount, u32 cacheSize = defaultCacheSize);
+	};
+
+}
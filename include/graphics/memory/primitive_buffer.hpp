@@ -1,6 +1,8 @@
 #pragma once
 #include "../graphics.hpp"
 #include "buffer_layout.hpp"
+#include "vertex_quantizer.hpp"
+#include "mesh_optimizer.hpp"
 
 namespace ignis {
 
@@ -27,6 +29,15 @@ namespace ignis {
 				GPUMemoryUsage usage = GPUMemoryUsage::LOCAL
 			):
 				vertexLayout{ vertexLayout }, indexLayout(indexLayout), usage(usage) { }
+
+			//Quantize the initData of the vertex layouts (see VertexQuantizer); predefined buffers are left as is
+			//Returns the bounds of the UNORM16 attributes by attribute index
+			HashMap<u32, VertexQuantizer::Dequantize> quantize(const VertexQuantizer::Modes &modes);
+
+			//Reorder the triangles (of a triangle list) and vertices in initData for the vertex caches (see MeshOptimizer)
+			//Vertices are only reordered if every vertex layout that isn't instanced has initData.
+			//32 bit indices are shrunk to 16 bit if there are at most 65535 vertices (0xFFFF stays the restart index)
+			MeshOptimizer::Stats optimize();
 		};
 
 		apimpl struct Data;
@@ -1,6 +1,7 @@
 #pragma once
 #include "graphics/memory/texture_object.hpp"
 #include "graphics/command/command_list.hpp"
+#include "graphics/memory/mapped_file.hpp"
 #include "types/grid.hpp"
 
 namespace ignis {
@@ -27,17 +28,43 @@ namespace ignis {
 
 		struct Info : public TextureObject::Info {
 
-			//Each mip is stored as an index into the list
-			//Each layer is stored in the grid
-			//[mip] Where each buffer.size = linearSize*layers
-			List<Buffer> initData;
+			//Where a layer of a mip is stored in initData (in the data format)
+			//Rows are rows of blocks for compressed formats; slices are 2D slices (the depth of a 3D texture)
+			struct Subresource { usz offset, rowPitch, slicePitch, size; };
+
+			//All mips and layers in one allocation; mip after mip and layer after layer
+			Buffer initData;
+
+			//[mip * layers + layer] Computed by layout()
+			List<Subresource> subresources;
+
+			//[mip * layers + layer] If non empty; init data is loaded from the files when it's needed
+			//Each region contains one layer of a mip (or the full mip of a 3D texture)
+			List<FileRegion> files;
 
 			//Pending ranges
 			List<TextureRange> pending;
 
+			//Ranges on the same mip are merged if that uploads at most maxMergeWaste bytes more
+			//Above maxPendingRanges, the pairs that waste the least are merged regardless;
+			//ranges of different mips are never merged, so every pending mip keeps at least one range
+			u64 maxMergeWaste = 4096;
+			u32 maxPendingRanges = 16;
+
 			//If the flush has already been registered
 			bool markedPending{};
 
+			//Format of initData and files if it differs from format (NONE if it doesn't)
+			//The texels are converted while they're staged for the upload; swapRB if they're stored as BGR(A)
+			GPUFormat dataFormat = GPUFormat::NONE;
+			bool swapRB{};
+
+			//Streaming textures upload their mips from the smallest to the largest; at most streamBudget bytes per flush
+			//(but at least one mip). Sampling is clamped to the resident mips, so the texture is usable after the first flush.
+			//The init data or files are kept, so dropped mips can be streamed in again
+			bool isStreaming{};
+			u64 streamBudget = 4 << 20;
+
 			//
 
 			using TextureObject::Info::Info;
@@ -70,16 +97,48 @@ namespace ignis {
 				GPUMemoryUsage usage, bool isCubeArray, u16 layers /* Should be a multiple of 6 (or 6 if !isCubeArray) */
 			);
 
-			//TODO: Compressed texture
+			//Compressed textures (FormatHelper::isCompressed) use init; each mip stores its blocks row by row
 
 			//List<Buffer> with a buffer per mip with each buffer of size layers * multiplied(resolution) * stride
 			bool init(const List<Buffer> &b);
+
+			//List<FileRegion> with a region per mip and layer ([mip * layers + layer]) of size multiplied(resolution) * stride
+			//Textures without CPU_WRITE upload straight from the file mapping without loading it into memory
+			bool init(const List<FileRegion> &regions);
+
+			//Buffer of the first mip of size layers * multiplied(resolution) * stride;
+			//the other mips are generated using the filter
+			bool init(const Buffer &mip0, MipFilter filter);
+
+			//Generate mip 1 until mips - 1 from the first mip in initData
+			//Only supported for non integer formats; srgba8 is filtered in linear space
+			bool generateMips(MipFilter filter = MipFilter::TRIANGLE);
+
+			//Compute the subresources for the data format; returns the bytes of all mips and layers
+			usz layout();
+
+			inline const Subresource &getSubresource(u8 mip, u16 layer = 0) const { return subresources[usz(mip) * layers + layer]; }
+			inline usz getMipOffset(u8 mip) const { return getSubresource(mip).offset; }
+			inline usz getMipBytes(u8 mip) const { return getSubresource(mip).size * layers; }
+
+			inline usz getDataBytes() const { return subresources.empty() ? 0 : subresources.back().offset + subresources.back().size; }
+			inline bool hasData() const { return !initData.empty() && initData.size() == getDataBytes(); }
+
+			//Convert initData into another data format on the CPU
+			bool convert(GPUFormat target);
+
+			inline GPUFormat getDataFormat() const { return dataFormat == GPUFormat::NONE ? format : dataFormat; }
+			inline bool needsConversion() const { return getDataFormat() != format || swapRB; }
+
+			//Encode initData into a block compressed format on the CPU; mips have to be generated before
+			//rgba8 -> bc1 or bc7, srgba8 -> bc1srgb or bc7srgb, r8 -> bc4, rg8 -> bc5
+			bool compress(GPUFormat target, CompressionQuality quality = CompressionQuality::NORMAL);
 		};
 
 		apimpl Texture(Graphics &g, const String &name, const Info &info);
 
 		inline const Info &getInfo() const { return info; }
-		inline u8 *getTextureData(usz mip = 0) { return info.initData[mip].data(); }
+		inline u8 *getTextureData(usz mip = 0) { return info.initData.data() + info.getMipOffset(u8(mip)); }
 
 		template<typename T>
 		inline oic::Grid1D<T> getTextureData1D(usz mip = 0);
@@ -96,9 +155,20 @@ namespace ignis {
 
 		void flush(const List<TextureRange> &ranges);	
 
+		//Streaming textures; mips >= getResidentMip() are uploaded and sampled
+		//A lower target streams more mips in on the next flushes, a higher target drops mips (e.g. under memory pressure)
+		void setStreamTarget(u8 mip);
+
+		inline u8 getStreamTarget() const { return targetMip; }
+		inline u8 getResidentMip() const { return residentMip; }
+		inline bool isResident() const { return residentMip <= targetMip; }
+
+		//The lowest mip that the next flush uploads (within the budget)
+		u8 getStreamMip() const;
+
 	private:
 
-		void mergePending();
+		void mergePending(usz i);
 
 		apimpl Pair<u64, u64> prepare(CommandList::Data*, UploadBuffer*);
 		apimpl void flush(CommandList::Data*, UploadBuffer*, const Pair<u64, u64>&);
@@ -106,6 +176,8 @@ namespace ignis {
 		apimpl ~Texture();
 
 		Info info;
+
+		u8 residentMip{}, targetMip{};
 	};
 
 	template<typename T, typename>
@@ -220,7 +292,7 @@ namespace ignis {
 		if (info.textureType != TextureType::TEXTURE_1D)
 			oic::System::log()->fatal("Can't get 1D texture data of a non 1D texture");
 
-		return oic::Grid1D<T>(info.initData[mip].data(), info.initData[mip].size());
+		return oic::Grid1D<T>(getTextureData(mip), info.getMipBytes(u8(mip)));
 	}
 
 	template<typename T>
@@ -235,7 +307,7 @@ namespace ignis {
 		)
 			oic::System::log()->fatal("Can't get 2D texture data of a non 2D texture");
 
-		return oic::Grid2D<T>(info.initData[mip].data(), info.initData[mip].size(), info.mipSizes[mip].x);
+		return oic::Grid2D<T>(getTextureData(mip), info.getMipBytes(u8(mip)), info.mipSizes[mip].x);
 	}
 
 	template<typename T>
@@ -252,7 +324,7 @@ namespace ignis {
 			oic::System::log()->fatal("Can't get 3D texture data of a non 3D texture");
 
 		return oic::Grid3D<T>(
-			info.initData[mip].data(), info.initData[mip].size(), info.mipSizes[mip].xy().cast<Vec2usz>()
+			getTextureData(mip), info.getMipBytes(u8(mip)), info.mipSizes[mip].xy().cast<Vec2usz>()
 		);
 	}
 
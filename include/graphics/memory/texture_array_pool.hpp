@@ -0,0 +1,92 @@
+#pragma once
+#include "graphics/memory/texture.hpp"
+#include "graphics/memory/upload_buffer.hpp"
+#include "graphics/shader/descriptors.hpp"
+
+namespace ignis {
+
+	//Places textures of the same size and format into the layers of shared TEXTURE_2D_ARRAYs
+	//Every handle in an array has the same getSubresource, so materials bind the array once
+	//and select their texture with getLayer (in a uniform) instead of switching descriptors.
+	//
+	//If every array is full, a new array is created (up to maxArrays).
+	//Arrays never move, so handles and descriptors referencing them stay valid
+	class TextureArrayPool {
+
+	public:
+
+		struct Handle {
+
+			u16 array = u16_MAX, layer = u16_MAX;
+
+			inline bool isValid() const { return array != u16_MAX; }
+		};
+
+		struct Info {
+
+			Vec2u16 dimensions;
+			GPUFormat format;
+			GPUMemoryUsage usage;			//CPU_WRITE is required for write
+
+			u8 mips;
+			u16 layersPerArray, maxArrays;
+
+			Info(
+				const Vec2u16 &dimensions, GPUFormat format, u8 mips = 1,
+				u16 layersPerArray = 64, u16 maxArrays = 16, GPUMemoryUsage usage = GPUMemoryUsage::CPU_WRITE
+			):
+				dimensions(dimensions), format(format), usage(usage),
+				mips(mips), layersPerArray(layersPerArray), maxArrays(maxArrays) {}
+		};
+
+		TextureArrayPool(Graphics &g, const String &name, const Info &info);
+
+		//Returns an invalid handle if every array is full; freed layers are reused first
+		Handle allocate();
+		void free(const Handle &handle);
+
+		//Copy a mip of a layer; src is tightly packed (rows of blocks for compressed formats)
+		bool write(const Handle &handle, const u8 *src, u8 mip = 0);
+
+		//Upload the written layers; add before the passes that sample the pool
+		//The command list has to be recorded again if getArrayCount changed
+		void addUploads(CommandList *commandList, UploadBuffer *uploadBuffer);
+
+		//Invalid (or freed) handles return an empty subresource
+
+		//The whole array of the handle (shared by every handle in the array)
+		GPUSubresource getSubresource(const Handle &handle, Sampler *sampler = nullptr) const;
+
+		//Only the layer of the handle as a TEXTURE_2D (for shaders that don't index the array)
+		GPUSubresource getLayerSubresource(const Handle &handle, Sampler *sampler = nullptr) const;
+
+		inline const Info &getInfo() const { return info; }
+
+		inline Texture *getArray(u16 i) const { return arrays[i].texture; }
+		inline u16 getArrayCount() const { return u16(arrays.size()); }
+
+		inline u16 getLayer(const Handle &handle) const { return handle.layer; }
+
+		inline bool isAllocated(const Handle &handle) const {
+			return handle.array < arrays.size() && handle.layer < info.layersPerArray && arrays[handle.array].used[handle.layer];
+		}
+
+		inline usz getAllocationCount() const { return allocations; }
+
+	private:
+
+		struct Array {
+			TextureRef texture;
+			List<bool> used;
+			List<u16> freeLayers;
+		};
+
+		Graphics &g;
+		String name;
+		Info info;
+
+		List<Array> arrays;
+		usz allocations{};
+	};
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "graphics/memory/texture.hpp"
+#include "graphics/memory/upload_buffer.hpp"
+
+namespace ignis {
+
+	//Where an allocation is in the atlas (excluding padding)
+	struct AtlasRegion { Vec2u16 offset, size; u16 layer; };
+
+	//Packs many small images (glyphs, icons) into the layers of one TEXTURE_2D_ARRAY
+	//Free space is tracked with a guillotine packer (best short side fit);
+	//writes mark the sub rectangle as pending through Texture::flush, so only the changed texels are uploaded.
+	//
+	//If a layer is full, the atlas grows into new layers (up to maxLayers).
+	//The texture has to be recreated for that, so getGeneration() changes and
+	//command lists and descriptors referencing the texture have to be updated
+	class TextureAtlas {
+
+	public:
+
+		static constexpr u32 invalid = u32_MAX;
+
+		struct Info {
+
+			Vec2u16 dimensions;			//Of a layer
+			GPUFormat format;			//Uncompressed
+
+			u16 layers, maxLayers;
+			u16 padding;				//Cleared texels around an allocation, so filtering doesn't bleed
+
+			Info(
+				const Vec2u16 &dimensions, GPUFormat format,
+				u16 maxLayers = 1, u16 padding = 1, u16 layers = 1
+			):
+				dimensions(dimensions), format(format), layers(layers), maxLayers(maxLayers), padding(padding) {}
+		};
+
+		TextureAtlas(Graphics &g, const String &name, const Info &info);
+
+		//Returns invalid if it doesn't fit (even after growing)
+		u32 allocate(const Vec2u16 &size);
+		void free(u32 id);
+
+		//Copy the texels of an allocation; rowPitch of src is tightly packed if 0
+		bool write(u32 id, const u8 *src, usz rowPitch = 0);
+
+		//Repack the allocations (tallest first) to reduce fragmentation; regions change and everything is uploaded again
+		//Returns false if they don't fit anymore (the atlas is left unchanged)
+		bool defragment();
+
+		//Upload the changed sub rectangles; add before the passes that sample the atlas
+		void addUploads(CommandList *commandList, UploadBuffer *uploadBuffer);
+
+		inline const Info &getInfo() const { return info; }
+		inline Texture *getTexture() const { return texture; }
+		inline u32 getGeneration() const { return generation; }
+
+		inline const AtlasRegion &getRegion(u32 id) const { return regions[id]; }
+		inline bool isAllocated(u32 id) const { return id < regions.size() && regions[id].size.x; }
+
+		inline usz getAllocationCount() const { return regions.size() - freeIds.size(); }
+
+	private:
+
+		struct Rect { Vec2u16 offset, size; u16 layer; };
+
+		bool place(const Vec2u16 &size, Rect &rect);
+		void release(const Rect &rect);
+
+		bool grow();
+		void create(const Buffer &data);
+
+		//Copy a padded rect; clears the padding and copies src into the inner region if it's not null
+		void copy(const Rect &rect, const u8 *src, usz rowPitch);
+
+		Graphics &g;
+		String name;
+		Info info;
+
+		TextureRef texture;
+		u32 generation{};
+
+		List<Rect> freeRects;
+
+		List<AtlasRegion> regions;		//[id]; size is 0 if it's free
+		List<Rect> padded;				//[id] Including padding
+		List<u32> freeIds;
+	};
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "graphics/memory/texture.hpp"
+
+namespace ignis {
+
+	//Parser for DDS and KTX2 texture containers
+	//The mips are referenced through FileRegions, so the texture uploads straight from the mapped file.
+	//Only supercompressed KTX2 (Zstandard or zlib) is decoded into initData; BasisLZ isn't supported
+	class TextureFile {
+
+	public:
+
+		//Overwrites everything but the usage of info with the texture in the file (detected by magic number)
+		static bool load(const String &path, Texture::Info &info);
+
+		static bool loadDDS(const String &path, Texture::Info &info);
+		static bool loadKTX2(const String &path, Texture::Info &info);
+
+	private:
+
+		//A parsed container; offset of every (mip, layer) into the file or decoded data
+		struct Layout {
+
+			TextureType type;
+			Vec3u16 dimensions;
+			GPUFormat format;
+			u8 mips;
+			u16 layers;
+
+			List<u64> offsets;			//[mip * layers + layer]
+			List<Buffer> decoded;		//[mip] If supercompressed
+		};
+
+		static bool finish(const String &path, u64 fileSize, const Layout &layout, Texture::Info &info);
+	};
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "graphics/memory/texture.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace ignis {
+
+	//A pool of threads that decode and prepare textures in the background
+	//Workers load the file, generate mips, compress and convert into the texture format,
+	//so the graphics thread only creates the texture and copies the data into the upload buffer (cmd::FlushImage)
+	class TextureLoader {
+
+	public:
+
+		//Custom decoder; fills info (dimensions, format and init data) from the job
+		using Decoder = bool (*)(void *instance, const String &path, Texture::Info &info);
+
+		struct Job {
+
+			String name;					//Name of the texture
+			String path;					//DDS or KTX2 (TextureFile) if there's no decoder
+
+			GPUMemoryUsage usage = GPUMemoryUsage::LOCAL;
+
+			Decoder decoder{};
+			void *instance{};
+
+			bool generateMips{};			//Generate the missing mips from the first mip
+			MipFilter filter = MipFilter::TRIANGLE;
+
+			GPUFormat compression = GPUFormat::NONE;	//Compress into this format
+			CompressionQuality quality = CompressionQuality::NORMAL;
+
+			bool isStreaming{};				//Upload the mips progressively (Texture::Info::isStreaming)
+		};
+
+		struct Loaded {
+			u64 id;
+			String name;
+			TextureRef texture;			//Null if the job failed
+		};
+
+		//Spawns a worker per hardware thread if threads is 0
+		TextureLoader(usz threads = 0);
+		~TextureLoader();
+
+		TextureLoader(const TextureLoader&) = delete;
+		TextureLoader &operator=(const TextureLoader&) = delete;
+
+		//Queue a job; returns the id it is finished with
+		u64 add(const Job &job);
+
+		//Create the textures of finished jobs; has to be called on a graphics thread
+		List<Loaded> finish(Graphics &g, usz maxTextures = usz_MAX);
+
+		//Wait until every job is finished (the textures still have to be created through finish)
+		void wait();
+
+		inline usz getThreadCount() const { return threads.size(); }
+
+	private:
+
+		struct Result {
+			u64 id;
+			String name;
+			Texture::Info info;
+			bool success;
+		};
+
+		void work();
+		static bool prepare(const Job &job, Texture::Info &info);
+
+		List<std::thread> threads;
+
+		std::mutex mutex;
+		std::condition_variable jobAdded, jobDone;
+
+		List<Pair<u64, Job>> jobs;
+		usz jobStart{};				//Jobs before this are taken
+
+		List<Result> results;
+
+		u64 counter{};
+		usz running{};
+		bool stop{};
+	};
+
+}
@@ -79,9 +79,9 @@ namespace ignis {
 		bool isValidSubType(const TextureType type) const;
 		bool isValidRange(const TextureRange &range) const;
 
-		//Gets the size in bytes of this texture objects on the GPU
+		//Gets the size in bytes of a layer of a mip on the GPU (every slice for 3D textures)
 		//"isStencil" represents if the stencil is being queried, this is only valid for depth textures
-		usz size(u8 mip = 0, u16 layer = 0, u16 depth = 0, bool isStencil = false) const;
+		usz size(u8 mip = 0, bool isStencil = false) const;
 
 		//Gets dimensions of this texture (with the layer in the correct slot)
 		Vec3u16 getDimensions(u8 mip = 0) const;
@@ -1,5 +1,6 @@
 #pragma once
 #include "gpu_buffer.hpp"
+#include "graphics/format.hpp"
 #include <mutex>
 
 namespace ignis {
@@ -18,6 +19,7 @@ namespace ignis {
 			static constexpr u64 freeBit = 1_u64 << 63;
 
 			u64 offset{}, sizeAndFree{}, executionId{}, bufferId{};
+			bool isDirty{};		//Written since the last flush
 
 			inline bool isFree() const { return sizeAndFree >> 63; }
 			inline u64 getSize() const { return sizeAndFree << 1 >> 1; }
@@ -48,9 +50,31 @@ namespace ignis {
 		//Returns { 0, u64_MAX } if no allocation possible
 		Pair<u64, u64> allocate(u64 executionId, const u8 *data, const usz size, u32 alignment);
 
+		//Gather the ranges (offset, size) of data into one tightly packed allocation
+		//Large gathers are split over multiple threads
+		Pair<u64, u64> allocate(u64 executionId, const u8 *data, const List<Vec2u64> &ranges, u32 alignment);
+
+		//Gather the spans (data, size) into one tightly packed allocation
+		Pair<u64, u64> allocate(u64 executionId, const List<Pair<const u8*, u64>> &spans, u32 alignment);
+
+		//Gather the spans of src texels into one allocation of dst texels; converted while copying
+		Pair<u64, u64> allocate(
+			u64 executionId, const List<Pair<const u8*, u64>> &spans, u32 alignment,
+			GPUFormat src, GPUFormat dst, bool swapRB = false
+		);
+
+		//Same as allocate, but the memory is left uninitialized and never flushed (e.g. for readbacks)
+		Pair<u64, u64> reserve(u64 executionId, const usz size, u32 alignment);
+
 		//Readback result
 		Buffer readback(const Pair<u64, u64> &allocation, u64 size);
 
+		//Readback result converted from src to dst texels (e.g. the result of presentToCpu)
+		Buffer readback(const Pair<u64, u64> &allocation, u64 size, GPUFormat src, GPUFormat dst, bool swapRB = false);
+
+		//Readback result without copying; only valid until the allocation is freed
+		const u8 *readbackView(const Pair<u64, u64> &allocation, u64 size);
+
 		const Info &getInfo() const { return info; }
 
 	protected:
@@ -63,6 +87,10 @@ namespace ignis {
 
 	private:
 
+		//Allocate without locking or initializing memory
+		//isDirty allocations are pushed to the GPU by the next flush
+		Pair<u64, u64> allocateInternal(u64 executionId, const usz size, u32 alignment, bool isDirty);
+
 		~UploadBuffer();
 
 		std::mutex mutex;
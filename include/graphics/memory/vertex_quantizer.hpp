@@ -0,0 +1,31 @@
+#pragma once
+#include "graphics/memory/buffer_layout.hpp"
+#include "types/vec.hpp"
+
+namespace ignis {
+
+	//Quantizes the f32 attributes of vertex data (BufferLayout::initData) before it's uploaded
+	//Attributes keep their index, but the formats, offsets and stride are rewritten;
+	//so the vertex inputs of pipelines have to use the quantized BufferAttributes.
+	//
+	//UNORM16 has to be decoded in the shader as offset + v * scale (e.g. from a per mesh uniform),
+	//OCTAHEDRAL as the normalized (x, y, 1 - |x| - |y|) with x, y = (1 - |y|, 1 - |x|) * sign if z < 0
+	struct VertexQuantizer {
+
+		//value = offset + quantized * scale
+		struct Dequantize {
+			Vec4f32 offset, scale;
+		};
+
+		//Quantization per attribute index; attributes that aren't listed are copied as is
+		using Modes = HashMap<u32, VertexQuantization>;
+
+		//Dequantize receives the bounds of every UNORM16 attribute (by attribute index)
+		//Returns an empty layout if the layout doesn't have initData or the modes don't fit the formats
+		static BufferLayout quantize(const BufferLayout &layout, const Modes &modes, HashMap<u32, Dequantize> *dequantize = nullptr);
+
+		//Format of an f32 attribute after quantization; NONE if the mode can't be applied to the format
+		static GPUFormat getFormat(GPUFormat format, VertexQuantization mode);
+	};
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "graphics/memory/texture.hpp"
+#include "graphics/memory/upload_buffer.hpp"
+
+namespace ignis {
+
+	//Matrices between normalized YUV texels and (non linear) RGB; rows of vec4 for a shader uniform
+	struct YUVConversion {
+
+		//rgb = m * (y, u, v, 1); bits is 8 or 10 (stored in the high bits of 16 bit texels)
+		static void toRGB(YUVMatrix matrix, YUVRange range, u8 bits, f32 (&m)[12]);
+
+		//(y, u, v) = m * (r, g, b, 1) as normalized 8 bit samples
+		static void toYUV(YUVMatrix matrix, YUVRange range, f32 (&m)[12]);
+	};
+
+	//Uploads video frames as their YUV planes and converts them to RGB on the GPU (cmd::ConvertYUV)
+	//This uploads the frame as is; 1.5 bytes per pixel for NV12 instead of 4 for rgba8
+	class VideoTexture {
+
+	public:
+
+		struct Info {
+
+			Vec2u16 dimensions;
+			VideoFormat format;
+
+			YUVMatrix matrix;
+			YUVRange range;
+
+			GPUFormat output;			//Of the converted texture; has to be GPU writable (e.g. rgba8, rgba16f)
+
+			YUVChromaSiting siting;
+
+			Info(
+				const Vec2u16 &dimensions, VideoFormat format,
+				YUVMatrix matrix = YUVMatrix::BT709, YUVRange range = YUVRange::LIMITED,
+				GPUFormat output = GPUFormat::rgba8, YUVChromaSiting siting = YUVChromaSiting::LEFT
+			):
+				dimensions(dimensions), format(format), matrix(matrix), range(range), output(output), siting(siting) {}
+		};
+
+		VideoTexture(Graphics &g, const String &name, const Info &info);
+
+		static u8 getPlaneCount(VideoFormat format);
+		static GPUFormat getPlaneFormat(VideoFormat format, u8 plane);
+		static Vec2u16 getPlaneSize(VideoFormat format, const Vec2u16 &dimensions, u8 plane);
+		static usz getFrameBytes(VideoFormat format, const Vec2u16 &dimensions);
+
+		//Copy a frame (every plane, tightly packed); returns false if a plane couldn't be written
+		bool write(const u8 *frame);
+
+		//Copy a region of a plane; only that region is uploaded
+		//rowPitch is tightly packed if 0 and size is the remainder of the plane if 0
+		bool write(u8 plane, const u8 *src, usz rowPitch = 0, const Vec2u16 &offset = {}, const Vec2u16 &size = {});
+
+		//Upload the written planes and convert them into the output texture
+		void addUploads(CommandList *commandList, UploadBuffer *uploadBuffer);
+
+		inline const Info &getInfo() const { return info; }
+
+		inline Texture *getPlane(u8 plane) const { return planes[plane]; }
+		inline Texture *getOutput() const { return output; }
+
+	private:
+
+		Info info;
+
+		List<TextureRef> planes;
+		TextureRef output;
+	};
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include "graphics/memory/texture.hpp"
+#include "graphics/memory/gpu_buffer.hpp"
+#include "graphics/memory/upload_buffer.hpp"
+#include "graphics/command/commands.hpp"
+
+namespace ignis {
+
+	//A tile of a virtual texture at a mip
+	struct VirtualTile { u16 x, y; u8 mip; };
+
+	//A texture that can be bigger than VRAM; only the tiles that are sampled stay resident
+	//The physical cache has a fixed size (Info::budget) independent of the virtual size and only lives on the GPU;
+	//loaded tiles are staged through the upload buffer
+	//
+	//The page table (rgba16u) has a mip per virtual mip and a texel per tile;
+	//(x, y) of the tile in the cache, the mip that is resident (a coarser one if not loaded) and 1.
+	//
+	//The pages that are needed are marked in the feedback buffer (one bit per page):
+	//	page = pageOffsets[mip] + y * max(pages.x >> mip, 1) + x
+	//	atomicOr(feedback[page >> 5], 1u << (page & 31));
+	//either by the shaders that sample it or by addFeedback from a requests texture of (u, v, mip, coverage).
+	//The feedback is read back asynchronously and update() streams the requested tiles in
+	class VirtualTexture {
+
+	public:
+
+		//Fill a tile of (tileSize + border * 2)^2 texels; rowPitch is the distance between texel (or block) rows
+		using TileLoader = bool (*)(void *instance, const VirtualTile &tile, u8 *dst, usz rowPitch);
+
+		struct Info {
+
+			Vec2u32 dimensions;			//Power of two
+			GPUFormat format;
+
+			u16 tileSize, border;		//tileSize has to be a power of two
+			u64 budget;					//Bytes available to the physical cache
+
+			u32 uploadsPerUpdate;		//Maximum tiles loaded per update
+
+			void *instance;
+			TileLoader loader;
+
+			Info(
+				const Vec2u32 &dimensions, GPUFormat format, u64 budget,
+				void *instance, TileLoader loader,
+				u16 tileSize = 128, u16 border = 4, u32 uploadsPerUpdate = 16
+			):
+				dimensions(dimensions), format(format), tileSize(tileSize), border(border),
+				budget(budget), uploadsPerUpdate(uploadsPerUpdate), instance(instance), loader(loader) {}
+		};
+
+		VirtualTexture(Graphics &g, const String &name, const Info &info);
+
+		//Upload the changed tiles and page table; add before the passes that sample the texture
+		void addUploads(CommandList *commandList, UploadBuffer *uploadBuffer);
+
+		//Read back and clear the feedback; add after the passes that write the feedback (or the requests)
+		//requests (if any) is resolved into the feedback first (see cmd::VirtualTextureFeedback)
+		void addFeedback(CommandList *commandList, UploadBuffer *uploadBuffer, TextureObject *requests = nullptr);
+
+		//Make the tiles from the latest feedback resident, evicting the least recently used tiles
+		void update();
+
+		inline const Info &getInfo() const { return info; }
+
+		inline Texture *getPageTable() const { return pageTable; }
+		inline Texture *getCache() const { return cache; }
+		inline GPUBuffer *getFeedback() const { return feedback; }
+
+		inline const List<u32> &getPageOffsets() const { return pageOffsets; }
+		inline Vec2u32 getPages(u8 mip = 0) const { return (pages / (1u << mip)).max(Vec2u32(1, 1)); }
+		inline Vec2u16 getCacheTiles() const { return cacheTiles; }
+		inline u8 getMips() const { return mips; }
+
+		inline bool isResident(const VirtualTile &tile) const { return pageSlots[pageId(tile)] != u32_MAX; }
+
+	private:
+
+		static constexpr u32 invalid = u32_MAX;
+
+		//A tile in the physical cache; part of the LRU list (if not pinned)
+		struct Slot {
+			u32 page = invalid;
+			u32 prev = invalid, next = invalid;
+			u64 lastUsed{};
+		};
+
+		inline u32 pageId(const VirtualTile &tile) const {
+			return pageOffsets[tile.mip] + u32(tile.y) * getPages(tile.mip).x + tile.x;
+		}
+
+		VirtualTile pageTile(u32 page) const;
+
+		void onFeedback(GPUBuffer*, const u8 *data, u64, u64 size);
+
+		bool load(const VirtualTile &tile, u32 slot);
+
+		void refresh(const VirtualTile &tile);
+		void flushPageTable();
+
+		void unlink(u32 slot);
+		void pushFront(u32 slot);
+
+		Info info;
+
+		TextureRef pageTable, cache;
+		GPUBufferRef feedback;
+
+		Vec2u32 pages;
+		Vec2u16 cacheTiles;
+		u8 mips;
+
+		List<u32> pageOffsets;			//[mip] First page of the mip
+		List<u32> pageSlots;			//[page] Slot of the page or invalid
+		List<Slot> slots;
+
+		List<u32> requested;			//Bit per page, merged from the feedback since the last update
+		List<Vec4u32> dirty;			//[mip] Changed pages of the page table (start, end)
+
+		cmd::UploadImage::Queue uploads;	//Tiles loaded since the last upload
+
+		u32 lruHead = invalid, lruTail = invalid;
+		u64 frame{};
+	};
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "types/types.hpp"
+#include <thread>
+
+namespace ignis {
+
+	//Set on threads that are already part of a pool (workers of parallelFor or a loader),
+	//so nested parallelFor calls run serially instead of oversubscribing the CPU
+	inline thread_local bool isPoolThread = false;
+
+	//Handing parts to the pool still costs some synchronization, so a thread should get enough work (e.g. multiply-adds or texels)
+	inline constexpr usz parallelMinWork = 1 << 16;
+
+	//Minimum number of items per thread if every item does workPerItem units of work
+	inline usz parallelMinItems(usz workPerItem) {
+		return std::max(parallelMinWork / std::max(workPerItem, usz(1)), usz(1));
+	}
+
+	//Run run(func, t) for every part t in [0, parts) on the calling thread and the persistent workers
+	//The workers are started on first use; one per hardware thread besides the caller
+	void parallelRun(usz parts, void (*run)(const void *func, usz part), const void *func);
+
+	//Run func(i) for every i in [0, count) spread over the hardware threads
+	//Threads are only used if every thread gets at least minPerThread items,
+	//so small workloads run on the calling thread without any overhead
+	template<typename Func>
+	inline void parallelFor(usz count, usz minPerThread, const Func &func) {
+
+		usz threads = std::max(usz(std::thread::hardware_concurrency()), usz(1));
+		threads = std::min(threads, count / std::max(minPerThread, usz(1)));
+
+		if (threads <= 1 || isPoolThread) {
+
+			for (usz i = 0; i < count; ++i)
+				func(i);
+
+			return;
+		}
+
+		//Split into equal parts
+
+		auto run = [&func, count, threads](usz t) {
+
+			usz end = (t + 1) * count / threads;
+
+			for (usz i = t * count / threads; i < end; ++i)
+				func(i);
+		};
+
+		using Run = decltype(run);
+
+		parallelRun(threads, [](const void *r, usz t) { (*(const Run*)r)(t); }, &run);
+	}
+
+}
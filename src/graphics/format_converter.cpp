@@ -0,0 +1,632 @@
+#include "graphics/format_converter.hpp"
+#include "graphics/parallel.hpp"
+#include "system/log.hpp"
+#include "system/system.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define IGNIS_CONVERT_SSE
+#endif
+
+#if defined(IGNIS_CONVERT_SSE) || defined(__F16C__)
+	#include <immintrin.h>
+#endif
+
+namespace ignis {
+
+	//Texels per job; big enough to hide the thread overhead and small enough for the scratch to stay in cache
+
+	static constexpr usz convertChunk = 1 << 14, convertBlock = 256;
+
+	//Half floats
+
+	static inline f32 halfToFloat1(u16 h) {
+
+		#ifdef __F16C__
+			return _cvtsh_ss(h);
+		#else
+
+			u32 sign = u32(h & 0x8000) << 16;
+			u32 exp = (h >> 10) & 0x1F;
+			u32 mant = h & 0x3FF;
+			u32 bits;
+
+			if (exp == 0x1F)
+				bits = sign | 0x7F800000 | (mant << 13);
+
+			else if (exp)
+				bits = sign | ((exp + 112) << 23) | (mant << 13);
+
+			else if (mant) {
+
+				exp = 113;
+
+				while (!(mant & 0x400)) {
+					mant <<= 1;
+					--exp;
+				}
+
+				bits = sign | (exp << 23) | ((mant & 0x3FF) << 13);
+			}
+
+			else bits = sign;
+
+			f32 f;
+			std::memcpy(&f, &bits, 4);
+			return f;
+
+		#endif
+	}
+
+	static inline u16 floatToHalf1(f32 f) {
+
+		#ifdef __F16C__
+			return _cvtss_sh(f, 0);
+		#else
+
+			u32 bits;
+			std::memcpy(&bits, &f, 4);
+
+			u16 sign = u16((bits >> 16) & 0x8000);
+			i32 exp = i32((bits >> 23) & 0xFF) - 112;
+			u32 mant = bits & 0x7FFFFF;
+
+			if (exp >= 0x1F)
+				return sign | (((bits & 0x7FFFFFFF) > 0x7F800000) ? 0x7E00 : 0x7C00);
+
+			if (exp <= 0) {
+
+				if (exp < -10)
+					return sign;
+
+				mant |= 0x800000;
+				u32 shift = u32(14 - exp);
+				u32 half = mant >> shift;
+				u32 rest = mant & ((1u << shift) - 1);
+				u32 mid = 1u << (shift - 1);
+
+				return u16(sign | (half + (rest > mid || (rest == mid && (half & 1)))));
+			}
+
+			u32 half = (u32(exp) << 10) | (mant >> 13);
+			u32 rest = mant & 0x1FFF;
+
+			return u16(sign | (half + (rest > 0x1000 || (rest == 0x1000 && (half & 1)))));
+
+		#endif
+	}
+
+	void FormatConverter::halfToFloat(const u16 *src, f32 *dst, usz count) {
+
+		usz i{};
+
+		#if defined(__F16C__) && defined(__AVX__)
+
+			for (; i + 8 <= count; i += 8)
+				_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i))));
+
+		#endif
+
+		for (; i < count; ++i)
+			dst[i] = halfToFloat1(src[i]);
+	}
+
+	void FormatConverter::floatToHalf(const f32 *src, u16 *dst, usz count) {
+
+		usz i{};
+
+		#if defined(__F16C__) && defined(__AVX__)
+
+			for (; i + 8 <= count; i += 8)
+				_mm_storeu_si128((__m128i*)(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), 0));
+
+		#endif
+
+		for (; i < count; ++i)
+			dst[i] = floatToHalf1(src[i]);
+	}
+
+	//sRGB lookup tables
+
+	static const f32 *srgbToLinearTable() {
+
+		static const auto table = []() {
+
+			List<f32> res(256);
+
+			for (usz i = 0; i < 256; ++i) {
+				f64 c = i / 255.0;
+				res[i] = f32(c <= .04045 ? c / 12.92 : std::pow((c + .055) / 1.055, 2.4));
+			}
+
+			return res;
+		}();
+
+		return table.data();
+	}
+
+	static constexpr usz linearToSrgbSize = 1 << 13;
+
+	static const u8 *linearToSrgbTable() {
+
+		static const auto table = []() {
+
+			List<u8> res(linearToSrgbSize);
+
+			for (usz i = 0; i < linearToSrgbSize; ++i) {
+				f64 c = (i + .5) / linearToSrgbSize;
+				c = c <= .0031308 ? c * 12.92 : 1.055 * std::pow(c, 1 / 2.4) - .055;
+				res[i] = u8(std::clamp(c * 255 + .5, 0.0, 255.0));
+			}
+
+			return res;
+		}();
+
+		return table.data();
+	}
+
+	//unorm8 <-> srgb8 without going through floats; [0] = to linear, [1] = to sRGB
+
+	static const u8 *srgbByteTable(bool toSrgb) {
+
+		static const auto table = []() {
+
+			List<u8> res(512);
+
+			const f32 *toLinear = srgbToLinearTable();
+			const u8 *fromLinear = linearToSrgbTable();
+
+			for (usz i = 0; i < 256; ++i) {
+				res[i] = u8(toLinear[i] * 255 + .5f);
+				res[256 + i] = fromLinear[std::min(usz(i / 255.0 * linearToSrgbSize), linearToSrgbSize - 1)];
+			}
+
+			return res;
+		}();
+
+		return table.data() + (toSrgb ? 256 : 0);
+	}
+
+	//Decode and encode a range on the current thread
+
+	static void decodeRange(GPUFormat format, const u8 *src, f32 *dst, usz texels) {
+
+		const usz channels = FormatHelper::getChannelCount(format);
+		const usz stride = FormatHelper::getStrideBytes(format);
+		const usz count = texels * channels;
+
+		usz i{};
+
+		switch (FormatHelper::getType(format)) {
+
+			case GPUFormatType::UNORM:
+
+				if (stride == 2) {
+
+					for (; i < count; ++i)
+						dst[i] = ((const u16*)src)[i] / 65535.f;
+
+					break;
+				}
+
+				if (FormatHelper::isSRGB(format)) {
+
+					const f32 *srgb = srgbToLinearTable();
+
+					for (; i < count; ++i)
+						dst[i] = i % channels != 3 ? srgb[src[i]] : src[i] / 255.f;
+
+					break;
+				}
+
+				#ifdef IGNIS_CONVERT_SSE
+
+					{
+						const __m128 scale = _mm_set1_ps(1 / 255.f);
+						const __m128i zero = _mm_setzero_si128();
+
+						for (; i + 16 <= count; i += 16) {
+
+							__m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+							__m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+
+							_mm_storeu_ps(dst + i,		_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+							_mm_storeu_ps(dst + i + 4,	_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+							_mm_storeu_ps(dst + i + 8,	_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+							_mm_storeu_ps(dst + i + 12,	_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+						}
+					}
+
+				#endif
+
+				for (; i < count; ++i)
+					dst[i] = src[i] / 255.f;
+
+				break;
+
+			case GPUFormatType::SNORM:
+
+				for (; i < count; ++i)
+					dst[i] = stride == 1 ? std::max(((const i8*)src)[i] / 127.f, -1.f) : std::max(((const i16*)src)[i] / 32767.f, -1.f);
+
+				break;
+
+			case GPUFormatType::UINT:
+
+				for (; i < count; ++i)
+					switch (stride) {
+						case 1:		dst[i] = f32(src[i]);					break;
+						case 2:		dst[i] = f32(((const u16*)src)[i]);		break;
+						case 4:		dst[i] = f32(((const u32*)src)[i]);		break;
+						default:	dst[i] = f32(((const u64*)src)[i]);
+					}
+
+				break;
+
+			case GPUFormatType::SINT:
+
+				for (; i < count; ++i)
+					switch (stride) {
+						case 1:		dst[i] = f32(((const i8*)src)[i]);		break;
+						case 2:		dst[i] = f32(((const i16*)src)[i]);		break;
+						case 4:		dst[i] = f32(((const i32*)src)[i]);		break;
+						default:	dst[i] = f32(((const i64*)src)[i]);
+					}
+
+				break;
+
+			default:
+
+				if (stride == 2)
+					FormatConverter::halfToFloat((const u16*)src, dst, count);
+
+				else if (stride == 4)
+					std::memcpy(dst, src, count * 4);
+
+				else for (; i < count; ++i)
+					dst[i] = f32(((const f64*)src)[i]);
+		}
+	}
+
+	template<typename T>
+	static inline T clampRound(f32 v, f64 lo, f64 hi) {
+		return T(std::clamp(std::round(f64(v)), lo, hi));
+	}
+
+	static void encodeRange(GPUFormat format, const f32 *src, u8 *dst, usz texels) {
+
+		const usz channels = FormatHelper::getChannelCount(format);
+		const usz stride = FormatHelper::getStrideBytes(format);
+		const usz count = texels * channels;
+
+		usz i{};
+
+		switch (FormatHelper::getType(format)) {
+
+			case GPUFormatType::UNORM:
+
+				if (stride == 2) {
+
+					for (; i < count; ++i)
+						((u16*)dst)[i] = u16(std::clamp(src[i], 0.f, 1.f) * 65535 + .5f);
+
+					break;
+				}
+
+				if (FormatHelper::isSRGB(format)) {
+
+					const u8 *srgb = linearToSrgbTable();
+
+					for (; i < count; ++i) {
+
+						f32 v = std::clamp(src[i], 0.f, 1.f);
+
+						dst[i] = i % channels != 3 ?
+							srgb[std::min(usz(v * linearToSrgbSize), linearToSrgbSize - 1)] : u8(v * 255 + .5f);
+					}
+
+					break;
+				}
+
+				#ifdef IGNIS_CONVERT_SSE
+
+					{
+						const __m128 scale = _mm_set1_ps(255), half = _mm_set1_ps(.5f);
+						const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1);
+
+						auto load = [&](usz j) {
+							__m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + j), zero), one);
+							return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+						};
+
+						for (; i + 16 <= count; i += 16) {
+
+							__m128i lo = _mm_packs_epi32(load(i), load(i + 4));
+							__m128i hi = _mm_packs_epi32(load(i + 8), load(i + 12));
+
+							_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+						}
+					}
+
+				#endif
+
+				for (; i < count; ++i)
+					dst[i] = u8(std::clamp(src[i], 0.f, 1.f) * 255 + .5f);
+
+				break;
+
+			case GPUFormatType::SNORM:
+
+				for (; i < count; ++i) {
+
+					f32 v = std::clamp(src[i], -1.f, 1.f);
+
+					if (stride == 1)
+						((i8*)dst)[i] = i8(std::round(v * 127));
+					else
+						((i16*)dst)[i] = i16(std::round(v * 32767));
+				}
+
+				break;
+
+			case GPUFormatType::UINT:
+
+				for (; i < count; ++i)
+					switch (stride) {
+						case 1:		dst[i] = clampRound<u8>(src[i], 0, u8_MAX);						break;
+						case 2:		((u16*)dst)[i] = clampRound<u16>(src[i], 0, u16_MAX);			break;
+						case 4:		((u32*)dst)[i] = clampRound<u32>(src[i], 0, u32_MAX);			break;
+						default:	((u64*)dst)[i] = u64(std::max(std::round(src[i]), 0.f));
+					}
+
+				break;
+
+			case GPUFormatType::SINT:
+
+				for (; i < count; ++i)
+					switch (stride) {
+						case 1:		((i8*)dst)[i] = clampRound<i8>(src[i], -128, 127);					break;
+						case 2:		((i16*)dst)[i] = clampRound<i16>(src[i], -32768, 32767);			break;
+						case 4:		((i32*)dst)[i] = clampRound<i32>(src[i], -2147483648.0, 2147483647.0);	break;
+						default:	((i64*)dst)[i] = i64(std::round(src[i]));
+					}
+
+				break;
+
+			default:
+
+				if (stride == 2)
+					FormatConverter::floatToHalf(src, (u16*)dst, count);
+
+				else if (stride == 4)
+					std::memcpy(dst, src, count * 4);
+
+				else for (; i < count; ++i)
+					((f64*)dst)[i] = src[i];
+		}
+	}
+
+	void FormatConverter::decode(GPUFormat format, const u8 *src, f32 *dst, usz texels) {
+
+		const usz channels = FormatHelper::getChannelCount(format), size = FormatHelper::getSizeBytes(format);
+
+		parallelFor((texels + convertChunk - 1) / convertChunk, 1, [&](usz chunk) {
+			usz start = chunk * convertChunk;
+			decodeRange(format, src + start * size, dst + start * channels, std::min(convertChunk, texels - start));
+		});
+	}
+
+	void FormatConverter::encode(GPUFormat format, const f32 *src, u8 *dst, usz texels) {
+
+		const usz channels = FormatHelper::getChannelCount(format), size = FormatHelper::getSizeBytes(format);
+
+		parallelFor((texels + convertChunk - 1) / convertChunk, 1, [&](usz chunk) {
+			usz start = chunk * convertChunk;
+			encodeRange(format, src + start * channels, dst + start * size, std::min(convertChunk, texels - start));
+		});
+	}
+
+	//Conversion
+
+	bool FormatConverter::canConvert(GPUFormat src, GPUFormat dst) {
+
+		if (
+			src == GPUFormat::NONE || dst == GPUFormat::NONE ||
+			FormatHelper::isCompressed(src) || FormatHelper::isCompressed(dst)
+		)
+			return false;
+
+		if (FormatHelper::isPacked(src) || FormatHelper::isPacked(dst))
+			return src == dst;
+
+		if (FormatHelper::isInt(src) || FormatHelper::isInt(dst))
+			return
+				FormatHelper::getType(src) == FormatHelper::getType(dst) &&
+				FormatHelper::getStrideBytes(src) == FormatHelper::getStrideBytes(dst);
+
+		return true;
+	}
+
+	//The bytes of 1 in a format (used for alpha)
+
+	static u64 oneOf(GPUFormat format) {
+
+		u64 one{};
+
+		if (FormatHelper::isInt(format)) {
+			one = 1;
+			return one;
+		}
+
+		f32 v = 1;
+		encodeRange(GPUFormat(GPUFormat::_E(u16(FormatHelper::getType(format)) << 4 | (u16(format.value) & 0xC))), &v, (u8*)&one, 1);
+		return one;
+	}
+
+	//Copy channels of the same type and stride, with swizzle, expand or reduce
+
+	static void shuffleRange(
+		const u8 *src, u8 *dst, usz texels, usz stride, usz srcChannels, usz dstChannels, bool swapRB, u64 one
+	) {
+
+		#if defined(__SSSE3__)
+
+			if (stride == 1 && srcChannels == 4 && dstChannels == 4 && swapRB) {
+
+				const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+				usz i{};
+
+				for (; i + 4 <= texels; i += 4)
+					_mm_storeu_si128(
+						(__m128i*)(dst + i * 4), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + i * 4)), mask)
+					);
+
+				src += i * 4;
+				dst += i * 4;
+				texels -= i;
+			}
+
+		#endif
+
+		//Source channel for every destination channel; missing ones are 0 or 1 (alpha)
+
+		usz mapping[4];
+
+		for (usz c = 0; c < 4; ++c) {
+
+			usz s = swapRB && (c == 0 || c == 2) && srcChannels >= 3 ? 2 - c : c;
+			mapping[c] = s < srcChannels ? s : usz_MAX;
+		}
+
+		const usz srcSize = srcChannels * stride, dstSize = dstChannels * stride;
+
+		for (usz i = 0; i < texels; ++i) {
+
+			const u8 *s = src + i * srcSize;
+			u8 *d = dst + i * dstSize;
+
+			for (usz c = 0; c < dstChannels; ++c)
+
+				if (mapping[c] != usz_MAX)
+					std::memcpy(d + c * stride, s + mapping[c] * stride, stride);
+
+				else if (c == 3)
+					std::memcpy(d + c * stride, &one, stride);
+
+				else std::memset(d + c * stride, 0, stride);
+		}
+	}
+
+	static void convertRange(
+		GPUFormat srcFormat, const u8 *src, GPUFormat dstFormat, u8 *dst, usz texels, bool swapRB, u64 one
+	) {
+
+		const usz srcChannels = FormatHelper::getChannelCount(srcFormat), dstChannels = FormatHelper::getChannelCount(dstFormat);
+		const usz srcStride = FormatHelper::getStrideBytes(srcFormat), dstStride = FormatHelper::getStrideBytes(dstFormat);
+
+		const GPUFormatType srcType = FormatHelper::getType(srcFormat), dstType = FormatHelper::getType(dstFormat);
+		const bool isSrgb = FormatHelper::isSRGB(srcFormat), toSrgb = FormatHelper::isSRGB(dstFormat);
+
+		//Swizzle, expand or reduce
+
+		if (srcType == dstType && srcStride == dstStride && isSrgb == toSrgb)
+			return shuffleRange(src, dst, texels, srcStride, srcChannels, dstChannels, swapRB, one);
+
+		//unorm8 <-> srgb8
+
+		if (
+			srcType == GPUFormatType::UNORM && dstType == GPUFormatType::UNORM &&
+			srcStride == 1 && dstStride == 1 && srcChannels == dstChannels
+		) {
+
+			const u8 *table = srgbByteTable(toSrgb);
+
+			if (swapRB)
+				shuffleRange(src, dst, texels, 1, srcChannels, dstChannels, true, one);
+
+			const u8 *in = swapRB ? dst : src;
+
+			for (usz i = 0, j = texels * dstChannels; i < j; ++i)
+				dst[i] = i % dstChannels != 3 ? table[in[i]] : in[i];
+
+			return;
+		}
+
+		//f32 <-> f16
+
+		if (
+			srcType == GPUFormatType::FLOAT && dstType == GPUFormatType::FLOAT &&
+			srcChannels == dstChannels && !swapRB
+		) {
+
+			if (srcStride == 4 && dstStride == 2)
+				return FormatConverter::floatToHalf((const f32*)src, (u16*)dst, texels * srcChannels);
+
+			if (srcStride == 2 && dstStride == 4)
+				return FormatConverter::halfToFloat((const u16*)src, (f32*)dst, texels * srcChannels);
+		}
+
+		//Through linear floats in small blocks, so the scratch stays in cache
+
+		f32 decoded[convertBlock * 4], remapped[convertBlock * 4];
+
+		const usz srcSize = FormatHelper::getSizeBytes(srcFormat), dstSize = FormatHelper::getSizeBytes(dstFormat);
+
+		for (usz i = 0; i < texels; i += convertBlock) {
+
+			usz n = std::min(convertBlock, texels - i);
+
+			decodeRange(srcFormat, src + i * srcSize, decoded, n);
+
+			const f32 *in = decoded;
+
+			if (srcChannels != dstChannels || swapRB) {
+
+				shuffleRange(
+					(const u8*)decoded, (u8*)remapped, n, sizeof(f32), srcChannels, dstChannels, swapRB, 0x3F800000
+				);
+
+				in = remapped;
+			}
+
+			encodeRange(dstFormat, in, dst + i * dstSize, n);
+		}
+	}
+
+	bool FormatConverter::convert(GPUFormat srcFormat, const u8 *src, GPUFormat dstFormat, u8 *dst, usz texels, bool swapRB) {
+
+		if (!canConvert(srcFormat, dstFormat) || (swapRB && FormatHelper::isPacked(srcFormat))) {
+			oic::System::log()->error("FormatConverter can't convert between the formats");
+			return false;
+		}
+
+		const usz srcSize = FormatHelper::getSizeBytes(srcFormat), dstSize = FormatHelper::getSizeBytes(dstFormat);
+		const usz chunks = (texels + convertChunk - 1) / convertChunk;
+
+		if (srcFormat == dstFormat && !swapRB) {
+
+			parallelFor(chunks, 4, [&](usz chunk) {
+				usz start = chunk * convertChunk;
+				std::memcpy(dst + start * dstSize, src + start * srcSize, std::min(convertChunk, texels - start) * srcSize);
+			});
+
+			return true;
+		}
+
+		const u64 one = oneOf(dstFormat);
+
+		parallelFor(chunks, 1, [&](usz chunk) {
+			usz start = chunk * convertChunk;
+			convertRange(
+				srcFormat, src + start * srcSize, dstFormat, dst + start * dstSize,
+				std::min(convertChunk, texels - start), swapRB, one
+			);
+		});
+
+		return true;
+	}
+
+}
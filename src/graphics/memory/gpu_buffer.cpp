@@ -5,15 +5,61 @@
 
 namespace ignis {
 
-	GPUBuffer::Info::Info(u64 bufferSize, GPUBufferUsage type, GPUMemoryUsage usage):
+	bool GPUBuffer::Info::initDynamic(u8 dynamicRegions) {
+
+		if (!HasFlags(usage, GPUMemoryUsage::DYNAMIC))
+			return false;
+
+		if (dynamicRegions < 2)
+			oic::System::log()->fatal("GPUBuffer::Info DYNAMIC requires at least 2 regions");
+
+		//initData (if any) is used to initialize all regions
+		usage |= GPUMemoryUsage::GPU_DYNAMIC;
+		regions = dynamicRegions;
+		pending.clear();
+		return true;
+	}
+
+	GPUBuffer::Info::Info(u64 bufferSize, GPUBufferUsage type, GPUMemoryUsage usage, u8 dynamicRegions):
 		initData(), size(bufferSize), type(type), usage(usage), pending { { 0, bufferSize }  }
 	{
-		if (!HasFlags(usage, GPUMemoryUsage::NO_CPU_MEMORY))
+		if (!initDynamic(dynamicRegions) && !HasFlags(usage, GPUMemoryUsage::NO_CPU_MEMORY) && !isMappedStaging())
 			initData.resize(bufferSize);
 	}
 
-	GPUBuffer::Info::Info(GPUBufferUsage type, GPUMemoryUsage usage, const Buffer &initData):
-		initData(initData), size(initData.size()), type(type), usage(usage), pending { { 0, initData.size() } } {}
+	GPUBuffer::Info::Info(GPUBufferUsage type, GPUMemoryUsage usage, const Buffer &initData, u8 dynamicRegions):
+		initData(initData), size(initData.size()), type(type), usage(usage), pending { { 0, initData.size() } } 
+	{
+		initDynamic(dynamicRegions);
+	}
+
+	GPUBuffer::Info::Info(GPUBufferUsage type, GPUMemoryUsage usage, const FileRegion &region, u8 dynamicRegions):
+		file(region), size(region.size), type(type), usage(usage)
+	{
+		if (!size) {
+
+			MappedFile mapped(file.path);
+
+			if (mapped.size() > file.offset)
+				size = file.size = mapped.size() - file.offset;
+		}
+
+		if (!size)
+			oic::System::log()->fatal("GPUBuffer::Info couldn't be initialized from file ", file.path);
+
+		pending = { { 0, size } };
+		initDynamic(dynamicRegions);
+	}
+
+	bool GPUBuffer::Info::isMappedStaging() const {
+		return 
+			(u32(type) & u32(GPUBufferUsage::STAGING)) && 
+			HasFlags(usage, GPUMemoryUsage::SHARED) && HasFlags(usage, GPUMemoryUsage::CPU_WRITE);
+	}
+
+	bool GPUBuffer::isDynamic() const {
+		return HasFlags(info.usage, GPUMemoryUsage::DYNAMIC);
+	}
 
 	bool GPUBuffer::isCompatible(GPUBufferType type, GPUBufferUsage usage) {
 
@@ -64,6 +110,62 @@ namespace ignis {
 		mergePending();
 	}
 
+	void GPUBuffer::resize(u64 size) {
+
+		if (isDynamic()) {
+			oic::System::log()->error("GPUBuffer::resize isn't supported for DYNAMIC buffers");
+			return;
+		}
+
+		if (!size) {
+			oic::System::log()->error("GPUBuffer::resize requires a non zero size");
+			return;
+		}
+
+		if (size == info.size)
+			return;
+
+		//Amortized growth and shrinking with hysteresis to avoid reallocating on every resize
+
+		u64 newCapacity = capacity;
+
+		if (size > capacity)
+			newCapacity = std::max(size, capacity + (capacity >> 1));
+
+		else if (size < (capacity >> 2))
+			newCapacity = size << 1;
+
+		if (newCapacity != capacity) {
+			reallocate(newCapacity, std::min(size, info.size));
+			capacity = newCapacity;
+		}
+
+		//Keep the CPU copy in sync; new memory is zero and has to be flushed if it was kept
+
+		bool hasCpuData = info.initData.size() == info.size;
+
+		if (hasCpuData)
+			info.initData.resize(size);
+
+		for (usz i = info.pending.size(); i > 0; --i) {
+
+			auto &pending = info.pending[i - 1];
+
+			if (pending.x >= size) {
+				pending = info.pending.back();
+				info.pending.pop_back();
+			}
+
+			else pending.y = std::min(pending.y, size - pending.x);
+		}
+
+		u64 oldSize = info.size;
+		info.size = size;
+
+		if (hasCpuData && size > oldSize)
+			flush(oldSize, size - oldSize);
+	}
+
 	void GPUBuffer::mergePending() {
 
 		//Resolve all pending
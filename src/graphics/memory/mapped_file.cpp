@@ -0,0 +1,179 @@
+#include "graphics/memory/mapped_file.hpp"
+#include "system/system.hpp"
+#include "system/log.hpp"
+
+#ifdef _WIN32
+
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <Windows.h>
+
+	#undef ERROR
+
+#else
+
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+
+#endif
+
+namespace ignis {
+
+	#ifdef _WIN32
+
+		MappedFile::MappedFile(const String &path): path(path) {
+
+			HANDLE f = CreateFileA(
+				path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, 
+				OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+			);
+
+			if (f == INVALID_HANDLE_VALUE) {
+				oic::System::log()->error("MappedFile couldn't open file ", path);
+				return;
+			}
+
+			file = f;
+
+			LARGE_INTEGER fileSize{};
+
+			if (!GetFileSizeEx(f, &fileSize) || !fileSize.QuadPart) {
+				oic::System::log()->error("MappedFile couldn't map an empty file ", path);
+				release();
+				return;
+			}
+
+			mapping = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+			if (!mapping) {
+				oic::System::log()->error("MappedFile couldn't map file ", path);
+				release();
+				return;
+			}
+
+			ptr = (const u8*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+			if (!ptr) {
+				oic::System::log()->error("MappedFile couldn't map file ", path);
+				release();
+				return;
+			}
+
+			length = u64(fileSize.QuadPart);
+		}
+
+		void MappedFile::release() {
+
+			if (ptr)
+				UnmapViewOfFile(ptr);
+
+			if (mapping)
+				CloseHandle(mapping);
+
+			if (file)
+				CloseHandle(file);
+
+			ptr = nullptr;
+			mapping = file = nullptr;
+			length = 0;
+		}
+
+	#else
+
+		//file holds the file descriptor + 1, so null is invalid
+
+		MappedFile::MappedFile(const String &path): path(path) {
+
+			int fd = open(path.c_str(), O_RDONLY);
+
+			if (fd < 0) {
+				oic::System::log()->error("MappedFile couldn't open file ", path);
+				return;
+			}
+
+			file = (void*) usz(fd + 1);
+
+			struct stat st{};
+
+			if (fstat(fd, &st) || !st.st_size) {
+				oic::System::log()->error("MappedFile couldn't map an empty file ", path);
+				release();
+				return;
+			}
+
+			void *addr = mmap(nullptr, usz(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if (addr == MAP_FAILED) {
+				oic::System::log()->error("MappedFile couldn't map file ", path);
+				release();
+				return;
+			}
+
+			madvise(addr, usz(st.st_size), MADV_SEQUENTIAL);
+
+			ptr = (const u8*) addr;
+			length = u64(st.st_size);
+		}
+
+		void MappedFile::release() {
+
+			if (ptr)
+				munmap((void*) ptr, usz(length));
+
+			if (file)
+				close(int(usz(file) - 1));
+
+			ptr = nullptr;
+			file = nullptr;
+			length = 0;
+		}
+
+	#endif
+
+	MappedFile::~MappedFile() { release(); }
+
+	MappedFile::MappedFile(MappedFile &&other) noexcept:
+		path(std::move(other.path)), ptr(other.ptr), length(other.length), file(other.file), mapping(other.mapping) 
+	{
+		other.ptr = nullptr;
+		other.file = other.mapping = nullptr;
+		other.length = 0;
+	}
+
+	MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+
+		release();
+
+		path = std::move(other.path);
+		ptr = other.ptr;
+		length = other.length;
+		file = other.file;
+		mapping = other.mapping;
+
+		other.ptr = nullptr;
+		other.file = other.mapping = nullptr;
+		other.length = 0;
+		return *this;
+	}
+
+	const u8 *MappedFile::get(u64 offset, u64 size) const {
+
+		if (!ptr || offset + size > length || offset + size < offset)
+			return nullptr;
+
+		return ptr + offset;
+	}
+
+	const u8 *MappedFile::get(List<MappedFile> &files, const FileRegion &region) {
+
+		for (auto &file : files)
+			if (file.path == region.path)
+				return file.get(region.offset, region.size);
+
+		files.push_back(MappedFile(region.path));
+		return files.back().get(region.offset, region.size);
+	}
+
+}
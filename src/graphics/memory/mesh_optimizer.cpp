@@ -0,0 +1,229 @@
+#include "graphics/memory/mesh_optimizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace ignis {
+
+	//Forsyth's scoring; vertices recently used or with few remaining triangles are preferred
+
+	static constexpr u32 scoreCacheSize = 32, scoreValenceSize = 32;
+
+	static constexpr f32 cacheDecayPower = 1.5f, lastTriangleScore = .75f;
+	static constexpr f32 valenceBoostScale = 2, valenceBoostPower = .5f;
+
+	struct ScoreTables {
+
+		f32 cache[scoreCacheSize], valence[scoreValenceSize];
+
+		ScoreTables() {
+
+			for (u32 i = 0; i < scoreCacheSize; ++i)
+				cache[i] = i < 3 ? lastTriangleScore : std::pow(1 - f32(i - 3) / (scoreCacheSize - 3), cacheDecayPower);
+
+			valence[0] = 0;
+
+			for (u32 i = 1; i < scoreValenceSize; ++i)
+				valence[i] = valenceBoostScale * std::pow(f32(i), -valenceBoostPower);
+		}
+
+		inline f32 score(i32 cachePos, u32 remaining) const {
+
+			if (!remaining)
+				return -1;
+
+			f32 res = cachePos < 0 ? 0 : cache[cachePos];
+
+			return res + (
+				remaining < scoreValenceSize ? valence[remaining] :
+				valenceBoostScale * std::pow(f32(remaining), -valenceBoostPower)
+			);
+		}
+	};
+
+	void MeshOptimizer::optimizeCache(u32 *indices, usz indexCount, u32 vertexCount) {
+
+		static const ScoreTables tables;
+
+		const usz triangleCount = indexCount / 3;
+
+		if (triangleCount < 2)
+			return;
+
+		List<u32> source(indices, indices + triangleCount * 3);
+
+		//Triangles per vertex
+
+		List<u32> offsets(usz(vertexCount) + 1), remaining(vertexCount);
+
+		for (u32 i : source)
+			++remaining[i];
+
+		for (u32 i = 0; i < vertexCount; ++i)
+			offsets[i + 1] = offsets[i] + remaining[i];
+
+		List<u32> adjacency(source.size()), fill(offsets.begin(), offsets.end() - 1);
+
+		for (usz i = 0; i < source.size(); ++i)
+			adjacency[fill[source[i]]++] = u32(i / 3);
+
+		List<i32> cachePos(vertexCount, -1);
+		List<f32> vertexScore(vertexCount);
+		List<bool> added(triangleCount);
+
+		for (u32 i = 0; i < vertexCount; ++i)
+			vertexScore[i] = tables.score(-1, remaining[i]);
+
+		usz best{};
+		f32 bestScore = -1;
+
+		for (usz t = 0; t < triangleCount; ++t) {
+
+			const u32 *tri = source.data() + t * 3;
+			const f32 score = vertexScore[tri[0]] + vertexScore[tri[1]] + vertexScore[tri[2]];
+
+			if (score > bestScore) {
+				bestScore = score;
+				best = t;
+			}
+		}
+
+		u32 cache[scoreCacheSize + 3], cacheCount{};
+		usz cursor{};
+
+		for (usz written = 0; written < triangleCount; ++written) {
+
+			//Nothing in the cache has triangles left; continue with the first triangle that wasn't added
+
+			if (best == usz_MAX) {
+
+				while (added[cursor])
+					++cursor;
+
+				best = cursor;
+			}
+
+			const u32 *tri = source.data() + best * 3;
+			std::memcpy(indices + written * 3, tri, 12);
+			added[best] = true;
+
+			for (usz i = 0; i < 3; ++i) {
+
+				const u32 v = tri[i];
+				u32 *adj = adjacency.data() + offsets[v];
+
+				for (u32 j = 0; j < remaining[v]; ++j)
+					if (adj[j] == best) {
+						std::swap(adj[j], adj[remaining[v] - 1]);
+						break;
+					}
+
+				--remaining[v];
+			}
+
+			//Move the triangle to the front of the LRU cache (degenerate triangles only once per vertex)
+
+			u32 next[scoreCacheSize + 3];
+			u32 nextCount{};
+
+			for (usz i = 0; i < 3; ++i)
+				if (std::find(next, next + nextCount, tri[i]) == next + nextCount)
+					next[nextCount++] = tri[i];
+
+			for (u32 i = 0; i < cacheCount; ++i)
+				if (cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2])
+					next[nextCount++] = cache[i];
+
+			for (u32 i = 0; i < nextCount; ++i) {
+				const u32 v = next[i];
+				cachePos[v] = i < scoreCacheSize ? i32(i) : -1;
+				vertexScore[v] = tables.score(cachePos[v], remaining[v]);
+			}
+
+			cacheCount = std::min(nextCount, scoreCacheSize);
+			std::memcpy(cache, next, cacheCount * 4);
+
+			//Only triangles of cached vertices are candidates
+
+			best = usz_MAX;
+			bestScore = -1;
+
+			for (u32 i = 0; i < cacheCount; ++i) {
+
+				const u32 v = cache[i];
+				const u32 *adj = adjacency.data() + offsets[v];
+
+				for (u32 j = 0; j < remaining[v]; ++j) {
+
+					const u32 t = adj[j];
+					const u32 *other = source.data() + usz(t) * 3;
+
+					const f32 score = vertexScore[other[0]] + vertexScore[other[1]] + vertexScore[other[2]];
+
+					if (score > bestScore) {
+						bestScore = score;
+						best = t;
+					}
+				}
+			}
+		}
+	}
+
+	List<u32> MeshOptimizer::optimizeFetch(u32 *indices, usz indexCount, u32 vertexCount) {
+
+		List<u32> remap(vertexCount, u32_MAX);
+		u32 next{};
+
+		for (usz i = 0; i < indexCount; ++i) {
+
+			u32 &dst = remap[indices[i]];
+
+			if (dst == u32_MAX)
+				dst = next++;
+
+			indices[i] = dst;
+		}
+
+		for (u32 &dst : remap)
+			if (dst == u32_MAX)
+				dst = next++;
+
+		return remap;
+	}
+
+	void MeshOptimizer::remapVertices(Buffer &data, usz stride, const List<u32> &remap) {
+
+		Buffer res(data.size());
+
+		for (usz i = 0, j = std::min(remap.size(), data.size() / stride); i < j; ++i)
+			std::memcpy(res.data() + usz(remap[i]) * stride, data.data() + i * stride, stride);
+
+		data = std::move(res);
+	}
+
+	f32 MeshOptimizer::getACMR(const u32 *indices, usz indexCount, u32 vertexCount, u32 cacheSize) {
+
+		const usz triangleCount = indexCount / 3;
+
+		if (!triangleCount)
+			return 0;
+
+		//A vertex is in the FIFO if fewer than cacheSize vertices were added after it
+
+		List<u32> timestamps(vertexCount);
+		u32 time = cacheSize + 1, misses{};
+
+		for (usz i = 0; i < triangleCount * 3; ++i) {
+
+			u32 &stamp = timestamps[indices[i]];
+
+			if (time - stamp > cacheSize) {
+				stamp = time++;
+				++misses;
+			}
+		}
+
+		return f32(misses) / triangleCount;
+	}
+
+}
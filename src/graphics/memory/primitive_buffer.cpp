@@ -3,6 +3,8 @@
 #include "utils/hash.hpp"
 #include "system/system.hpp"
 #include "system/log.hpp"
+#include <algorithm>
+#include <cstring>
 
 namespace ignis {
 
@@ -10,6 +12,114 @@ namespace ignis {
 		formats(formats), buffer(b), bufferOffset(bufferOffset),
 		elements(u32(b->size() / formats.getStride())) {}
 
+	HashMap<u32, VertexQuantizer::Dequantize> PrimitiveBuffer::Info::quantize(const VertexQuantizer::Modes &modes) {
+
+		HashMap<u32, VertexQuantizer::Dequantize> res;
+
+		for (auto &layout : vertexLayout) {
+
+			if (layout.buffer)
+				continue;
+
+			BufferLayout quantized = VertexQuantizer::quantize(layout, modes, &res);
+
+			if (quantized.elements)
+				layout = std::move(quantized);
+		}
+
+		return res;
+	}
+
+	MeshOptimizer::Stats PrimitiveBuffer::Info::optimize() {
+
+		auto it = std::find_if(vertexLayout.begin(), vertexLayout.end(), [](const BufferLayout &l) { return !l.instanced(); });
+
+		if (indexLayout.initData.empty() || indexLayout.formats.size() != 1 || it == vertexLayout.end()) {
+			oic::System::log()->error("PrimitiveBuffer::Info::optimize requires indices in initData and vertices");
+			return {};
+		}
+
+		const GPUFormat format = indexLayout.formats[0].format;
+
+		if (
+			format != GPUFormat::r32u && format != GPUFormat::r32i &&
+			format != GPUFormat::r16u && format != GPUFormat::r16i
+		) {
+			oic::System::log()->error("PrimitiveBuffer::Info::optimize requires a 32 or 16 bit (unsigned) int index format");
+			return {};
+		}
+
+		const u32 vertexCount = it->elements;
+		const usz stride = FormatHelper::getSizeBytes(format), count = indexLayout.initData.size() / stride;
+
+		List<u32> indices(count);
+
+		for (usz i = 0; i < count; ++i) {
+
+			if (stride == 2) {
+				u16 v;
+				std::memcpy(&v, indexLayout.initData.data() + i * 2, 2);
+				indices[i] = v;
+			}
+
+			else std::memcpy(&indices[i], indexLayout.initData.data() + i * 4, 4);
+
+			if (indices[i] >= vertexCount) {
+				oic::System::log()->error("PrimitiveBuffer::Info::optimize found an index out of bounds");
+				return {};
+			}
+		}
+
+		MeshOptimizer::Stats stats{};
+		stats.acmrBefore = MeshOptimizer::getACMR(indices.data(), count, vertexCount);
+
+		MeshOptimizer::optimizeCache(indices.data(), count, vertexCount);
+		stats.acmrAfter = MeshOptimizer::getACMR(indices.data(), count, vertexCount);
+
+		bool canRemap = true;
+
+		for (auto &layout : vertexLayout)
+			if (!layout.instanced() && (layout.buffer || layout.elements != vertexCount))
+				canRemap = false;
+
+		if (canRemap) {
+
+			List<u32> remap = MeshOptimizer::optimizeFetch(indices.data(), count, vertexCount);
+
+			for (auto &layout : vertexLayout)
+				if (!layout.instanced())
+					MeshOptimizer::remapVertices(layout.initData, layout.stride(), remap);
+		}
+
+		else oic::System::log()->warn("PrimitiveBuffer::Info::optimize can't reorder predefined vertex buffers");
+
+		//Shrink the indices
+
+		GPUFormat dstFormat = format;
+
+		if (vertexCount <= 0xFFFF && stride == 4)
+			dstFormat = format == GPUFormat::r32u ? GPUFormat::r16u : GPUFormat::r16i;
+
+		const usz dstStride = FormatHelper::getSizeBytes(dstFormat);
+		Buffer data(count * dstStride);
+
+		for (usz i = 0; i < count; ++i)
+			if (dstStride == 2) {
+				u16 v = u16(indices[i]);
+				std::memcpy(data.data() + i * 2, &v, 2);
+			}
+			else std::memcpy(data.data() + i * 4, &indices[i], 4);
+
+		indexLayout.initData = std::move(data);
+
+		if (dstFormat != format) {
+			const auto &attrib = indexLayout.formats[0];
+			indexLayout.formats = BufferAttributes(indexLayout.instanced(), BufferAttributes::Attrib(attrib.offset, attrib.index, dstFormat));
+		}
+
+		return stats;
+	}
+
 	PrimitiveBuffer::PrimitiveBuffer(
 		Graphics &g, const String &name, const Info &inf
 	):
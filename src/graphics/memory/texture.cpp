@@ -1,11 +1,39 @@
 #include "graphics/memory/texture.hpp"
 #include "graphics/shader/descriptors.hpp"
+#include "graphics/format_converter.hpp"
 #include "utils/math.hpp"
 #include "system/log.hpp"
 #include "system/system.hpp"
+#include <cstring>
 
 namespace ignis {
 
+	usz Texture::Info::layout() {
+
+		GPUFormat source = getDataFormat();
+		bool is1DArray = textureType == TextureType::TEXTURE_1D_ARRAY;
+
+		subresources.resize(usz(mips) * layers);
+
+		usz offset{};
+
+		for (u8 m = 0; m < mips; ++m) {
+
+			const Vec3u16 &dim = mipSizes[m];
+
+			//Layers of 1D arrays are rows; other layers are slices (3D textures have one layer with every slice)
+
+			usz rowPitch = FormatHelper::getImageBytes(source, dim.x);
+			usz slicePitch = is1DArray ? rowPitch : FormatHelper::getImageBytes(source, dim.x, dim.y);
+			usz size = layers > 1 || is1DArray ? slicePitch : slicePitch * dim.z;
+
+			for (u16 l = 0; l < layers; ++l, offset += size)
+				subresources[usz(m) * layers + l] = { offset, rowPitch, slicePitch, size };
+		}
+
+		return offset;
+	}
+
 	bool Texture::Info::init(const List<Buffer> &b) {
 
 		if (b.size() != usz(mips)) {
@@ -13,23 +41,81 @@ namespace ignis {
 			return false;
 		}
 
-		Vec3u16 res = dimensions;
+		layout();
+
+		for (u8 m = 0; m < mips; ++m)
+			if (b[m].size() != getMipBytes(m) || b[m].empty()) {
+				oic::System::log()->error("Invalid texture size");
+				return false;
+			}
 
-		for (usz m = 0; m < mips; ++m) {
+		initData.resize(getDataBytes());
 
-			usz size =
-				FormatHelper::getSizeBytes(format) * 
-				res.x * res.y * res.z * layers;
+		for (u8 m = 0; m < mips; ++m)
+			std::memcpy(initData.data() + getMipOffset(m), b[m].data(), b[m].size());
 
-			if (b[m].size() != size || !size) {
-				oic::System::log()->error("Invalid texture size");
+		return true;
+	}
+
+	bool Texture::Info::init(const Buffer &mip0, MipFilter filter) {
+
+		layout();
+
+		if (mip0.size() != getMipBytes(0) || mip0.empty()) {
+			oic::System::log()->error("Invalid texture size");
+			return false;
+		}
+
+		initData = mip0;
+		return generateMips(filter);
+	}
+
+	bool Texture::Info::init(const List<FileRegion> &regions) {
+
+		if (regions.size() != usz(mips) * layers) {
+			oic::System::log()->error("Texture requires a file region for every mip and layer");
+			return false;
+		}
+
+		layout();
+
+		for (usz i = 0; i < regions.size(); ++i)
+			if (regions[i].size != subresources[i].size || !regions[i].size) {
+				oic::System::log()->error("Invalid texture file region size");
 				return false;
 			}
 
-			res = (res.cast<Vec3f64>() / 2).ceil().cast<Vec3u16>();
+		files = regions;
+		return true;
+	}
+
+	bool Texture::Info::convert(GPUFormat target) {
+
+		GPUFormat source = getDataFormat();
+
+		if (!FormatConverter::canConvert(source, target)) {
+			oic::System::log()->error("Texture::Info::convert can't convert between the formats");
+			return false;
 		}
 
-		initData = b;
+		if (files.size()) {
+			oic::System::log()->error("Texture::Info::convert requires the init data to be in memory");
+			return false;
+		}
+
+		//Mips are contiguous, so the texture is converted at once
+
+		Buffer converted(FormatConverter::getConvertedBytes(source, target, initData.size()));
+
+		if (!FormatConverter::convert(source, initData.data(), target, converted.data(), initData.size() / FormatHelper::getSizeBytes(source), swapRB))
+			return false;
+
+		initData.swap(converted);
+
+		dataFormat = target == format ? GPUFormat(GPUFormat::NONE) : target;
+		swapRB = false;
+
+		layout();
 		return true;
 	}
 
@@ -39,58 +125,173 @@ namespace ignis {
 			if(!isValidRange(range))
 				oic::System::log()->fatal("Texture::flush out of bounds");
 
-		for(auto &range : ranges)
+		for (auto &range : ranges) {
 			info.pending.push_back(range);
+			mergePending(info.pending.size() - 1);
+		}
+	}
+
+	void Texture::setStreamTarget(u8 mip) {
 
-		mergePending();
+		if (!info.isStreaming) {
+			oic::System::log()->error("Texture::setStreamTarget requires a streaming texture");
+			return;
+		}
+
+		targetMip = std::min(mip, u8(info.mips - 1));
 	}
 
+	u8 Texture::getStreamMip() const {
 
-	void Texture::mergePending() {
+		if (residentMip <= targetMip)
+			return targetMip;
 
-		constexpr i32 
-			delta1D = 15,	//If there's a 1D difference of <=15 texels
-			delta2D = 7,	//If there's a 2D difference of <=7 texels
-			delta3D = 3;	//If there's a 3D difference of <=3 texels
+		//Smallest mips first; the first mip is always uploaded, even if it's over the budget
 
-		auto *back = &info.pending.back();
+		u8 mip = residentMip;
+		u64 bytes{};
 
-		do {
+		while (mip > targetMip) {
 
-			auto dim = getDimensions(back->mip);
+			u64 mipBytes = info.getMipBytes(u8(mip - 1));
 
-			const i32 delta = dim.z ? delta3D : (dim.y ? delta2D : delta1D);
+			if (mip != residentMip && bytes + mipBytes > info.streamBudget)
+				break;
 
-			auto *oldBack = back;
+			bytes += mipBytes;
+			--mip;
+		}
 
-			for (auto &pending : info.pending) {
+		return mip;
+	}
 
-				if (&pending == back || pending.mip != back->mip)
-					continue;
+	//Bytes that would be uploaded needlessly if a and b are uploaded as one range
+
+	static inline i64 mergeWaste(GPUFormat format, const TextureRange &a, const TextureRange &b) {
+
+		auto bytes = [format](const Vec3u16 &size) -> i64 {
+			return i64(FormatHelper::getImageBytes(format, size.x, size.y, size.z));
+		};
+
+		Vec3u16 start = a.start.min(b.start);
+		Vec3u16 end = (a.start + a.size).max(b.start + b.size);
+
+		Vec3u16 overlapStart = a.start.max(b.start);
+		Vec3u16 overlapEnd = (a.start + a.size).min(b.start + b.size);
+
+		i64 overlap = (overlapStart < overlapEnd).all() ? bytes(overlapEnd - overlapStart) : 0;
+
+		return bytes(end - start) - (bytes(a.size) + bytes(b.size) - overlap);
+	}
 
-				Vec3i32 diffBegin = (pending.start + pending.size - back->start).cast<Vec3i32>();
-				Vec3i32 diffEnd = (pending.start - back->start - back->size).cast<Vec3i32>();
+	//Merge range j into range i and swap remove j; returns the new index of i
 
-				if ((diffBegin >= -delta).all() && (diffEnd <= delta).all()) {
+	static usz mergeRanges(List<TextureRange> &pending, usz i, usz j) {
 
-					auto start = pending.start;
+		auto &target = pending[i];
+		const auto &range = pending[j];
 
-					pending.start = pending.start.min(back->start);
-					pending.size = (start + pending.size).max(back->start + back->size) - pending.start;
+		Vec3u16 end = (target.start + target.size).max(range.start + range.size);
+		target.start = target.start.min(range.start);
+		target.size = end - target.start;
 
-					usz off = &pending - info.pending.data();
+		if (i == pending.size() - 1)
+			i = j;
+
+		pending[j] = pending.back();
+		pending.pop_back();
+
+		return i;
+	}
+
+	//Index of the range of the same mip that wastes the least bytes when merged with range i (or pending.size())
+
+	static usz mergePartner(GPUFormat format, const List<TextureRange> &pending, usz i, i64 &waste) {
+
+		const auto &range = pending[i];
+
+		usz best = pending.size();
+		waste = i64_MAX;
+
+		for (usz j = 0, k = pending.size(); j < k; ++j) {
+
+			if (j == i || pending[j].mip != range.mip)
+				continue;
+
+			i64 w = mergeWaste(format, pending[j], range);
+
+			if (w < waste) {
+				waste = w;
+				best = j;
+			}
+		}
 
-					info.pending.erase(info.pending.begin() + (back - info.pending.data()));
-					back = info.pending.data() + off;
-					break;
+		return best;
+	}
+
+	void Texture::mergePending(usz i) {
+
+		auto &pending = info.pending;
+
+		//Merge the range with the range that wastes the least bytes;
+		//repeat for the merged range since it might overlap others now
+
+		while (true) {
+
+			i64 waste;
+			usz best = mergePartner(info.format, pending, i, waste);
+
+			if (best == pending.size() || waste > i64(info.maxMergeWaste))
+				break;
+
+			i = mergeRanges(pending, best, i);
+		}
+
+		//Over the range limit; merge the new range with its cheapest partner even if it wastes bytes.
+		//The other ranges were within the limit already, so only the pairs with the new range are compared
+
+		while (pending.size() > info.maxPendingRanges) {
+
+			i64 waste;
+			usz best = mergePartner(info.format, pending, i, waste);
+
+			if (best != pending.size()) {
+				i = mergeRanges(pending, best, i);
+				continue;
+			}
+
+			//The only range of its mip; merge the cheapest pair of the other mips instead
+
+			usz bestA = pending.size(), bestB{};
+			i64 bestWaste = i64_MAX;
+
+			for (usz a = 0, k = pending.size(); a < k; ++a) {
+
+				if (a == i)
+					continue;
+
+				usz b = mergePartner(info.format, pending, a, waste);
+
+				if (b != pending.size() && waste < bestWaste) {
+					bestWaste = waste;
+					bestA = a;
+					bestB = b;
 				}
 			}
 
-			if (oldBack == back || info.pending.size() == 1)
+			if (bestA == pending.size())
 				break;
 
-		} while (true);
+			//Keep track of the new range if the swap remove moves it
 
+			usz last = pending.size() - 1;
+			usz removed = std::max(bestA, bestB);
+
+			mergeRanges(pending, std::min(bestA, bestB), removed);
+
+			if (i == last)
+				i = removed;
+		}
 	}
 
 }
\ No newline at end of file
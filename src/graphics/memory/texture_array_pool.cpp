@@ -0,0 +1,129 @@
+#include "graphics/memory/texture_array_pool.hpp"
+#include "graphics/command/commands.hpp"
+#include "system/log.hpp"
+#include "system/system.hpp"
+#include <cstring>
+
+namespace ignis {
+
+	TextureArrayPool::TextureArrayPool(Graphics &g, const String &name, const Info &inf): g(g), name(name), info(inf) {
+
+		if (!info.dimensions.x || !info.dimensions.y || !info.mips || !info.layersPerArray || !info.maxArrays)
+			oic::System::log()->fatal("TextureArrayPool created with invalid dimensions, mips or layers");
+	}
+
+	TextureArrayPool::Handle TextureArrayPool::allocate() {
+
+		//Fill the first arrays first, so fewer arrays are bound
+
+		u16 i{};
+
+		for (u16 j = u16(arrays.size()); i < j; ++i)
+			if (arrays[i].freeLayers.size())
+				break;
+
+		if (i == arrays.size()) {
+
+			if (arrays.size() >= info.maxArrays)
+				return {};
+
+			Texture::Info texInfo(
+				TextureType::TEXTURE_2D_ARRAY, Vec3u16(info.dimensions.x, info.dimensions.y, 1),
+				info.format, info.usage, info.mips, info.layersPerArray, 1, true
+			);
+
+			Array arr{
+				TextureRef(g, name + " " + std::to_string(i), texInfo),
+				List<bool>(info.layersPerArray),
+				List<u16>()
+			};
+
+			arr.freeLayers.reserve(info.layersPerArray);
+
+			for (u16 l = info.layersPerArray; l > 0; --l)
+				arr.freeLayers.push_back(u16(l - 1));
+
+			arrays.push_back(std::move(arr));
+		}
+
+		Array &arr = arrays[i];
+
+		u16 layer = arr.freeLayers.back();
+		arr.freeLayers.pop_back();
+		arr.used[layer] = true;
+
+		++allocations;
+		return { i, layer };
+	}
+
+	void TextureArrayPool::free(const Handle &handle) {
+
+		if (!isAllocated(handle)) {
+			oic::System::log()->error("TextureArrayPool::free called on an invalid handle");
+			return;
+		}
+
+		Array &arr = arrays[handle.array];
+		arr.used[handle.layer] = false;
+		arr.freeLayers.push_back(handle.layer);
+
+		--allocations;
+	}
+
+	bool TextureArrayPool::write(const Handle &handle, const u8 *src, u8 mip) {
+
+		if (!isAllocated(handle) || !src || mip >= info.mips) {
+			oic::System::log()->error("TextureArrayPool::write called on an invalid handle or mip");
+			return false;
+		}
+
+		if (!HasFlags(info.usage, GPUMemoryUsage::CPU_WRITE)) {
+			oic::System::log()->error("TextureArrayPool::write requires CPU_WRITE");
+			return false;
+		}
+
+		Texture *tex = arrays[handle.array].texture;
+		const auto &sub = tex->getInfo().getSubresource(mip, handle.layer);
+
+		std::memcpy(tex->getTextureData() + sub.offset, src, sub.size);
+
+		const Vec3u16 &size = tex->getInfo().mipSizes[mip];
+
+		tex->flush({ TextureRange{ Vec3u16(0, 0, handle.layer), Vec3u16(size.x, size.y, 1), mip } });
+		return true;
+	}
+
+	void TextureArrayPool::addUploads(CommandList *commandList, UploadBuffer *uploadBuffer) {
+		for (auto &arr : arrays)
+			commandList->add(cmd::FlushImage(arr.texture, uploadBuffer));
+	}
+
+	GPUSubresource TextureArrayPool::getSubresource(const Handle &handle, Sampler *sampler) const {
+
+		if (!isAllocated(handle)) {
+			oic::System::log()->error("TextureArrayPool::getSubresource called on an invalid handle");
+			return {};
+		}
+
+		Texture *tex = arrays[handle.array].texture;
+
+		return sampler ?
+			GPUSubresource(sampler, tex, TextureType::TEXTURE_2D_ARRAY) :
+			GPUSubresource(tex, TextureType::TEXTURE_2D_ARRAY);
+	}
+
+	GPUSubresource TextureArrayPool::getLayerSubresource(const Handle &handle, Sampler *sampler) const {
+
+		if (!isAllocated(handle)) {
+			oic::System::log()->error("TextureArrayPool::getLayerSubresource called on an invalid handle");
+			return {};
+		}
+
+		Texture *tex = arrays[handle.array].texture;
+
+		return sampler ?
+			GPUSubresource(sampler, tex, TextureType::TEXTURE_2D, info.mips, 1, 0, handle.layer) :
+			GPUSubresource(tex, TextureType::TEXTURE_2D, info.mips, 1, 0, handle.layer);
+	}
+
+}
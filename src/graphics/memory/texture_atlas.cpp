@@ -0,0 +1,322 @@
+#include "graphics/memory/texture_atlas.hpp"
+#include "graphics/command/commands.hpp"
+#include "system/log.hpp"
+#include "system/system.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace ignis {
+
+	TextureAtlas::TextureAtlas(Graphics &g, const String &name, const Info &inf): g(g), name(name), info(inf) {
+
+		if (FormatHelper::isCompressed(info.format))
+			oic::System::log()->fatal("TextureAtlas doesn't support compressed formats");
+
+		if (!info.dimensions.x || !info.dimensions.y || !info.layers || info.layers > info.maxLayers)
+			oic::System::log()->fatal("TextureAtlas created with invalid dimensions or layers");
+
+		for (u16 l = 0; l < info.layers; ++l)
+			freeRects.push_back({ Vec2u16{}, info.dimensions, l });
+
+		create(Buffer(FormatHelper::getImageBytes(info.format, info.dimensions.x, info.dimensions.y, info.layers)));
+	}
+
+	void TextureAtlas::create(const Buffer &data) {
+
+		Texture::Info texInfo(
+			TextureType::TEXTURE_2D_ARRAY, Vec3u16(info.dimensions.x, info.dimensions.y, 1),
+			info.format, GPUMemoryUsage::CPU_WRITE, 1, info.layers, 1, true
+		);
+
+		texInfo.init(List<Buffer>{ data });
+
+		//The previous texture is still registered (and might be referenced by command lists), so the name has to differ
+
+		String texName = generation ? name + " " + std::to_string(generation) : name;
+
+		texture = TextureRef(g, NAME(texName), texInfo);
+		++generation;
+	}
+
+	void TextureAtlas::addUploads(CommandList *commandList, UploadBuffer *uploadBuffer) {
+		commandList->add(cmd::FlushImage(texture, uploadBuffer));
+	}
+
+	//Allocation
+
+	u32 TextureAtlas::allocate(const Vec2u16 &size) {
+
+		if (!size.x || !size.y)
+			return invalid;
+
+		const u32 pad = u32(info.padding) * 2;
+
+		if (size.x + pad > info.dimensions.x || size.y + pad > info.dimensions.y)
+			return invalid;
+
+		Vec2u16 paddedSize = Vec2u16(u16(size.x + pad), u16(size.y + pad));
+		Rect rect;
+
+		while (!place(paddedSize, rect))
+			if (!grow())
+				return invalid;
+
+		u32 id;
+
+		if (freeIds.size()) {
+			id = freeIds.back();
+			freeIds.pop_back();
+		}
+
+		else {
+			id = u32(regions.size());
+			regions.push_back({});
+			padded.push_back({});
+		}
+
+		padded[id] = rect;
+		regions[id] = { rect.offset + Vec2u16(info.padding, info.padding), size, rect.layer };
+		return id;
+	}
+
+	void TextureAtlas::free(u32 id) {
+
+		if (!isAllocated(id)) {
+			oic::System::log()->error("TextureAtlas::free called on an invalid allocation");
+			return;
+		}
+
+		release(padded[id]);
+
+		regions[id] = {};
+		freeIds.push_back(id);
+	}
+
+	//Best short side fit; the leftover is split along the shorter axis so the bigger piece stays as large as possible
+
+	bool TextureAtlas::place(const Vec2u16 &size, Rect &rect) {
+
+		usz best = freeRects.size();
+		u32 bestShort = u32_MAX, bestLong = u32_MAX;
+
+		for (usz i = 0, j = freeRects.size(); i < j; ++i) {
+
+			const Rect &r = freeRects[i];
+
+			if (r.size.x < size.x || r.size.y < size.y)
+				continue;
+
+			u32 dx = u32(r.size.x - size.x), dy = u32(r.size.y - size.y);
+			u32 shortSide = std::min(dx, dy), longSide = std::max(dx, dy);
+
+			if (shortSide < bestShort || (shortSide == bestShort && longSide < bestLong)) {
+				best = i;
+				bestShort = shortSide;
+				bestLong = longSide;
+			}
+		}
+
+		if (best == freeRects.size())
+			return false;
+
+		Rect r = freeRects[best];
+		freeRects[best] = freeRects.back();
+		freeRects.pop_back();
+
+		rect = { r.offset, size, r.layer };
+
+		u16 dx = u16(r.size.x - size.x), dy = u16(r.size.y - size.y);
+
+		Rect right, bottom;
+
+		if (dx < dy) {
+			right = { Vec2u16(u16(r.offset.x + size.x), r.offset.y), Vec2u16(dx, size.y), r.layer };
+			bottom = { Vec2u16(r.offset.x, u16(r.offset.y + size.y)), Vec2u16(r.size.x, dy), r.layer };
+		}
+
+		else {
+			right = { Vec2u16(u16(r.offset.x + size.x), r.offset.y), Vec2u16(dx, r.size.y), r.layer };
+			bottom = { Vec2u16(r.offset.x, u16(r.offset.y + size.y)), Vec2u16(size.x, dy), r.layer };
+		}
+
+		if (right.size.x && right.size.y) freeRects.push_back(right);
+		if (bottom.size.x && bottom.size.y) freeRects.push_back(bottom);
+
+		return true;
+	}
+
+	//Merge free rects that share a full edge, until nothing changes
+
+	void TextureAtlas::release(const Rect &rect) {
+
+		freeRects.push_back(rect);
+
+		bool merged = true;
+
+		while (merged) {
+
+			merged = false;
+
+			Rect &r = freeRects.back();
+
+			for (usz i = 0, j = freeRects.size() - 1; i < j; ++i) {
+
+				const Rect &o = freeRects[i];
+
+				if (o.layer != r.layer)
+					continue;
+
+				bool horizontal =
+					o.offset.y == r.offset.y && o.size.y == r.size.y &&
+					(o.offset.x + o.size.x == r.offset.x || r.offset.x + r.size.x == o.offset.x);
+
+				bool vertical =
+					o.offset.x == r.offset.x && o.size.x == r.size.x &&
+					(o.offset.y + o.size.y == r.offset.y || r.offset.y + r.size.y == o.offset.y);
+
+				if (!horizontal && !vertical)
+					continue;
+
+				Vec2u16 start = o.offset.min(r.offset);
+
+				r.size = horizontal ?
+					Vec2u16(u16(o.size.x + r.size.x), r.size.y) :
+					Vec2u16(r.size.x, u16(o.size.y + r.size.y));
+
+				r.offset = start;
+
+				//Keep the merged rect at the back
+
+				freeRects[i] = freeRects[j - 1];
+				freeRects[j - 1] = freeRects[j];
+				freeRects.pop_back();
+
+				merged = true;
+				break;
+			}
+		}
+	}
+
+	//Recreate the texture with more layers; the existing layers are kept
+
+	bool TextureAtlas::grow() {
+
+		if (info.layers >= info.maxLayers)
+			return false;
+
+		u16 layers = u16(std::min(u32(info.layers) * 2, u32(info.maxLayers)));
+
+		Buffer data(FormatHelper::getImageBytes(info.format, info.dimensions.x, info.dimensions.y, layers));
+		std::memcpy(data.data(), texture->getTextureData(), texture->getInfo().initData.size());
+
+		for (u16 l = info.layers; l < layers; ++l)
+			freeRects.push_back({ Vec2u16{}, info.dimensions, l });
+
+		info.layers = layers;
+		create(data);
+		return true;
+	}
+
+	//Texel data
+
+	void TextureAtlas::copy(const Rect &rect, const u8 *src, usz rowPitch) {
+
+		const usz stride = FormatHelper::getSizeBytes(info.format);
+		const auto &sub = texture->getInfo().getSubresource(0, rect.layer);
+
+		const usz pad = info.padding;
+		const usz inner = (rect.size.x - pad * 2) * stride;
+
+		u8 *dst = texture->getTextureData() + sub.offset + rect.offset.y * sub.rowPitch + rect.offset.x * stride;
+
+		for (usz y = 0; y < rect.size.y; ++y, dst += sub.rowPitch) {
+
+			if (!src || y < pad || y >= rect.size.y - pad) {
+				std::memset(dst, 0, rect.size.x * stride);
+				continue;
+			}
+
+			std::memset(dst, 0, pad * stride);
+			std::memcpy(dst + pad * stride, src + (y - pad) * rowPitch, inner);
+			std::memset(dst + pad * stride + inner, 0, pad * stride);
+		}
+
+		texture->flush({ TextureRange{
+			Vec3u16(rect.offset.x, rect.offset.y, rect.layer), Vec3u16(rect.size.x, rect.size.y, 1), 0
+		} });
+	}
+
+	bool TextureAtlas::write(u32 id, const u8 *src, usz rowPitch) {
+
+		if (!isAllocated(id) || !src) {
+			oic::System::log()->error("TextureAtlas::write called on an invalid allocation");
+			return false;
+		}
+
+		if (!rowPitch)
+			rowPitch = regions[id].size.x * FormatHelper::getSizeBytes(info.format);
+
+		copy(padded[id], src, rowPitch);
+		return true;
+	}
+
+	bool TextureAtlas::defragment() {
+
+		List<u32> ids;
+		ids.reserve(getAllocationCount());
+
+		for (u32 i = 0, j = u32(regions.size()); i < j; ++i)
+			if (regions[i].size.x)
+				ids.push_back(i);
+
+		std::sort(ids.begin(), ids.end(), [this](u32 a, u32 b) {
+			return padded[a].size.y != padded[b].size.y ? padded[a].size.y > padded[b].size.y : padded[a].size.x > padded[b].size.x;
+		});
+
+		//Place into empty layers; restore if it doesn't fit
+
+		List<Rect> oldFree = std::move(freeRects), oldPadded = padded;
+		freeRects.clear();
+
+		for (u16 l = 0; l < info.layers; ++l)
+			freeRects.push_back({ Vec2u16{}, info.dimensions, l });
+
+		for (u32 id : ids)
+			if (!place(padded[id].size, padded[id])) {
+				freeRects = std::move(oldFree);
+				padded = std::move(oldPadded);
+				return false;
+			}
+
+		//Move the texels; the padding is copied along with the allocation
+
+		const usz stride = FormatHelper::getSizeBytes(info.format);
+		const auto &texInfo = texture->getInfo();
+
+		Buffer old(texInfo.initData);
+		u8 *data = texture->getTextureData();
+
+		std::memset(data, 0, old.size());
+
+		for (u32 id : ids) {
+
+			const Rect &from = oldPadded[id], &to = padded[id];
+
+			const auto &src = texInfo.getSubresource(0, from.layer), &dst = texInfo.getSubresource(0, to.layer);
+
+			for (usz y = 0; y < to.size.y; ++y)
+				std::memcpy(
+					data + dst.offset + (to.offset.y + y) * dst.rowPitch + to.offset.x * stride,
+					old.data() + src.offset + (from.offset.y + y) * src.rowPitch + from.offset.x * stride,
+					to.size.x * stride
+				);
+
+			regions[id].offset = to.offset + Vec2u16(info.padding, info.padding);
+			regions[id].layer = to.layer;
+		}
+
+		texture->flush({ TextureRange{ Vec3u16{}, Vec3u16(info.dimensions.x, info.dimensions.y, info.layers), 0 } });
+		return true;
+	}
+
+}
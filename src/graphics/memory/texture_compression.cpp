@@ -0,0 +1,898 @@
+#include "graphics/memory/texture.hpp"
+#include "graphics/parallel.hpp"
+#include "graphics/format_converter.hpp"
+#include "system/log.hpp"
+#include "system/system.hpp"
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define IGNIS_COMPRESS_SSE
+	#include <immintrin.h>
+#endif
+
+namespace ignis {
+
+	using BlockTexels = u8[16][4];
+
+	#ifdef IGNIS_COMPRESS_SSE
+
+		//Squared distance between the 16 bit pairs (x, y) and (z, w) of a texel and 4 palette entries
+		//The pairs are interleaved per entry, so madd sums them into one i32 per entry
+
+		static inline __m128i blockDistance(__m128i texelXY, __m128i texelZW, __m128i palXY, __m128i palZW) {
+
+			__m128i xy = _mm_sub_epi16(texelXY, palXY);
+			__m128i zw = _mm_sub_epi16(texelZW, palZW);
+
+			return _mm_add_epi32(_mm_madd_epi16(xy, xy), _mm_madd_epi16(zw, zw));
+		}
+
+		//Minimum of 4 i32s (SSE2 has no min_epi32)
+
+		static inline __m128i blockMin(__m128i a, __m128i b) {
+			__m128i lt = _mm_cmplt_epi32(a, b);
+			return _mm_or_si128(_mm_and_si128(lt, a), _mm_andnot_si128(lt, b));
+		}
+
+		static inline i32 blockHorizontalMin(__m128i v) {
+			v = blockMin(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+			v = blockMin(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtsi128_si32(v);
+		}
+
+	#endif
+
+	//Endpoint fitting
+
+	static void fitBoundingBox(const BlockTexels &px, usz channels, const bool *use, f32 *e0, f32 *e1) {
+
+		for (usz c = 0; c < channels; ++c) {
+			e0[c] = 255;
+			e1[c] = 0;
+		}
+
+		for (usz i = 0; i < 16; ++i)
+			if (!use || use[i])
+				for (usz c = 0; c < channels; ++c) {
+					e0[c] = std::min(e0[c], f32(px[i][c]));
+					e1[c] = std::max(e1[c], f32(px[i][c]));
+				}
+
+		//Inset the box; the extremes are rarely the best fit
+
+		for (usz c = 0; c < channels; ++c) {
+			f32 inset = (e1[c] - e0[c]) / 16;
+			e0[c] += inset;
+			e1[c] -= inset;
+		}
+	}
+
+	//Fit the endpoints on the principal axis of the texels
+
+	static void fitPrincipalAxis(const BlockTexels &px, usz channels, const bool *use, f32 *e0, f32 *e1) {
+
+		f32 mean[4]{};
+		usz count{};
+
+		for (usz i = 0; i < 16; ++i)
+			if (!use || use[i]) {
+
+				for (usz c = 0; c < channels; ++c)
+					mean[c] += px[i][c];
+
+				++count;
+			}
+
+		for (usz c = 0; c < channels; ++c)
+			mean[c] /= f32(count);
+
+		f32 cov[4][4]{};
+
+		for (usz i = 0; i < 16; ++i)
+			if (!use || use[i])
+				for (usz a = 0; a < channels; ++a)
+					for (usz b = 0; b < channels; ++b)
+						cov[a][b] += (px[i][a] - mean[a]) * (px[i][b] - mean[b]);
+
+		//Power iteration, starting at the bounding box diagonal
+
+		f32 axis[4]{};
+		fitBoundingBox(px, channels, use, e0, e1);
+
+		for (usz c = 0; c < channels; ++c)
+			axis[c] = e1[c] - e0[c];
+
+		for (u32 it = 0; it < 8; ++it) {
+
+			f32 next[4]{};
+			f32 len{};
+
+			for (usz a = 0; a < channels; ++a) {
+
+				for (usz b = 0; b < channels; ++b)
+					next[a] += cov[a][b] * axis[b];
+
+				len = std::max(len, std::abs(next[a]));
+			}
+
+			if (len < 1e-6f)
+				break;
+
+			for (usz c = 0; c < channels; ++c)
+				axis[c] = next[c] / len;
+		}
+
+		f32 axisLen{};
+
+		for (usz c = 0; c < channels; ++c)
+			axisLen += axis[c] * axis[c];
+
+		//Flat blocks keep the bounding box
+
+		if (axisLen < 1e-6f)
+			return;
+
+		f32 tMin = 1e30f, tMax = -1e30f;
+
+		for (usz i = 0; i < 16; ++i)
+			if (!use || use[i]) {
+
+				f32 t{};
+
+				for (usz c = 0; c < channels; ++c)
+					t += (px[i][c] - mean[c]) * axis[c];
+
+				tMin = std::min(tMin, t);
+				tMax = std::max(tMax, t);
+			}
+
+		f32 inset = (tMax - tMin) / 16;
+		tMin += inset;
+		tMax -= inset;
+
+		for (usz c = 0; c < channels; ++c) {
+			e0[c] = std::clamp(mean[c] + axis[c] * tMin / axisLen, 0.f, 255.f);
+			e1[c] = std::clamp(mean[c] + axis[c] * tMax / axisLen, 0.f, 255.f);
+		}
+	}
+
+	static void fitEndpoints(const BlockTexels &px, usz channels, const bool *use, CompressionQuality quality, f32 *e0, f32 *e1) {
+
+		if (quality == CompressionQuality::FAST)
+			fitBoundingBox(px, channels, use, e0, e1);
+		else
+			fitPrincipalAxis(px, channels, use, e0, e1);
+	}
+
+	//Least squares endpoints for the chosen interpolation weights (0 = e0, 1 = e1)
+
+	static bool refineEndpoints(const BlockTexels &px, usz channels, const bool *use, const f32 *weights, f32 *e0, f32 *e1) {
+
+		f32 a{}, b{}, c{}, d0[4]{}, d1[4]{};
+
+		for (usz i = 0; i < 16; ++i) {
+
+			if (use && !use[i])
+				continue;
+
+			f32 w = weights[i], iw = 1 - w;
+
+			a += iw * iw;
+			b += iw * w;
+			c += w * w;
+
+			for (usz k = 0; k < channels; ++k) {
+				d0[k] += iw * px[i][k];
+				d1[k] += w * px[i][k];
+			}
+		}
+
+		f32 det = a * c - b * b;
+
+		if (std::abs(det) < 1e-6f)
+			return false;
+
+		for (usz k = 0; k < channels; ++k) {
+			e0[k] = std::clamp((c * d0[k] - b * d1[k]) / det, 0.f, 255.f);
+			e1[k] = std::clamp((a * d1[k] - b * d0[k]) / det, 0.f, 255.f);
+		}
+
+		return true;
+	}
+
+	//BC1; 565 endpoints with 2 bit indices and 1 bit alpha
+
+	static u16 packRGB565(const f32 *c) {
+		return u16(
+			(u32(std::clamp(std::round(c[0] * 31 / 255), 0.f, 31.f)) << 11) |
+			(u32(std::clamp(std::round(c[1] * 63 / 255), 0.f, 63.f)) << 5) |
+			u32(std::clamp(std::round(c[2] * 31 / 255), 0.f, 31.f))
+		);
+	}
+
+	static void unpackRGB565(u16 v, i32 *c) {
+
+		i32 r = v >> 11, g = (v >> 5) & 63, b = v & 31;
+
+		c[0] = (r << 3) | (r >> 2);
+		c[1] = (g << 2) | (g >> 4);
+		c[2] = (b << 3) | (b >> 2);
+	}
+
+	static u64 bc1Indices(const BlockTexels &px, u16 c0, u16 c1, bool threeColor, u32 &indices) {
+
+		i32 pal[4][3];
+		unpackRGB565(c0, pal[0]);
+		unpackRGB565(c1, pal[1]);
+
+		for (usz c = 0; c < 3; ++c)
+			if (threeColor) {
+				pal[2][c] = (pal[0][c] + pal[1][c]) / 2;
+				pal[3][c] = 0;
+			}
+			else {
+				pal[2][c] = (2 * pal[0][c] + pal[1][c]) / 3;
+				pal[3][c] = (pal[0][c] + 2 * pal[1][c]) / 3;
+			}
+
+		u64 error{};
+		indices = 0;
+
+		#ifdef IGNIS_COMPRESS_SSE
+
+			//The error is shifted up, so the minimum also holds the first index with that error
+
+			__m128i palXY = _mm_setr_epi16(
+				i16(pal[0][0]), i16(pal[0][1]), i16(pal[1][0]), i16(pal[1][1]),
+				i16(pal[2][0]), i16(pal[2][1]), i16(pal[3][0]), i16(pal[3][1])
+			);
+
+			__m128i palZW = _mm_setr_epi16(
+				i16(pal[0][2]), 0, i16(pal[1][2]), 0, i16(pal[2][2]), 0, i16(pal[3][2]), 0
+			);
+
+			const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+			const __m128i unused = threeColor ? _mm_setr_epi32(0, 0, 0, i32_MAX) : _mm_setzero_si128();
+
+			for (usz i = 0; i < 16; ++i) {
+
+				u32 best = 3;
+
+				if (!threeColor || px[i][3] >= 128) {
+
+					__m128i xy = _mm_set1_epi32(i32(px[i][0] | (u32(px[i][1]) << 16)));
+					__m128i zw = _mm_set1_epi32(i32(px[i][2]));
+
+					__m128i key = _mm_or_si128(_mm_slli_epi32(blockDistance(xy, zw, palXY, palZW), 2), lanes);
+					i32 m = blockHorizontalMin(_mm_or_si128(key, unused));
+
+					best = u32(m & 3);
+					error += u64(m >> 2);
+				}
+
+				indices |= best << (i * 2);
+			}
+
+		#else
+
+			for (usz i = 0; i < 16; ++i) {
+
+				u32 best{};
+
+				if (threeColor && px[i][3] < 128)
+					best = 3;
+
+				else {
+
+					i32 bestError = i32_MAX;
+
+					for (u32 j = 0, end = threeColor ? 3 : 4; j < end; ++j) {
+
+						i32 e{};
+
+						for (usz c = 0; c < 3; ++c) {
+							i32 d = i32(px[i][c]) - pal[j][c];
+							e += d * d;
+						}
+
+						if (e < bestError) {
+							bestError = e;
+							best = j;
+						}
+					}
+
+					error += u64(bestError);
+				}
+
+				indices |= best << (i * 2);
+			}
+
+		#endif
+
+		return error;
+	}
+
+	//Order the endpoints for the mode and pick the indices
+
+	static u64 bc1Encode(const BlockTexels &px, const f32 *e0, const f32 *e1, bool threeColor, u16 &c0, u16 &c1, u32 &indices) {
+
+		c0 = packRGB565(e1);
+		c1 = packRGB565(e0);
+
+		//c0 > c1 selects 4 colors, c0 <= c1 selects 3 colors and transparency
+
+		if ((c0 < c1) != threeColor && c0 != c1)
+			std::swap(c0, c1);
+
+		return bc1Indices(px, c0, c1, threeColor || c0 == c1, indices);
+	}
+
+	static void encodeBC1(const BlockTexels &px, CompressionQuality quality, u8 *dst) {
+
+		bool use[16];
+		bool threeColor{}, any{};
+
+		for (usz i = 0; i < 16; ++i) {
+			use[i] = px[i][3] >= 128;
+			threeColor |= !use[i];
+			any |= use[i];
+		}
+
+		u16 c0{}, c1{};
+		u32 indices = u32_MAX;
+
+		if (any) {
+
+			f32 e0[3], e1[3];
+			fitEndpoints(px, 3, use, quality, e0, e1);
+
+			u64 error = bc1Encode(px, e0, e1, threeColor, c0, c1, indices);
+
+			//Refine the endpoints to the least squares fit of the chosen indices
+
+			if (quality == CompressionQuality::HIGH && !threeColor && c0 != c1)
+				for (u32 it = 0; it < 2 && error; ++it) {
+
+					static constexpr f32 bc1Weights[] = { 0, 1, 1 / 3.f, 2 / 3.f };
+
+					f32 weights[16];
+
+					for (usz i = 0; i < 16; ++i)
+						weights[i] = bc1Weights[(indices >> (i * 2)) & 3];
+
+					i32 p0[3], p1[3];
+					unpackRGB565(c0, p0);
+					unpackRGB565(c1, p1);
+
+					f32 r0[3] = { f32(p0[0]), f32(p0[1]), f32(p0[2]) };
+					f32 r1[3] = { f32(p1[0]), f32(p1[1]), f32(p1[2]) };
+
+					if (!refineEndpoints(px, 3, use, weights, r0, r1))
+						break;
+
+					u16 n0, n1;
+					u32 nIndices;
+					u64 nError = bc1Encode(px, r1, r0, false, n0, n1, nIndices);
+
+					if (nError >= error)
+						break;
+
+					error = nError;
+					c0 = n0;
+					c1 = n1;
+					indices = nIndices;
+				}
+		}
+
+		std::memcpy(dst, &c0, 2);
+		std::memcpy(dst + 2, &c1, 2);
+		std::memcpy(dst + 4, &indices, 4);
+	}
+
+	//BC4; 8 bit endpoints with 3 bit indices
+
+	static void bc4Palette(u8 r0, u8 r1, u8 *pal) {
+
+		pal[0] = r0;
+		pal[1] = r1;
+
+		if (r0 > r1)
+			for (u32 i = 2; i < 8; ++i)
+				pal[i] = u8(((8 - i) * r0 + (i - 1) * r1 + 3) / 7);
+
+		else {
+
+			for (u32 i = 2; i < 6; ++i)
+				pal[i] = u8(((6 - i) * r0 + (i - 1) * r1 + 2) / 5);
+
+			pal[6] = 0;
+			pal[7] = 255;
+		}
+	}
+
+	static u64 bc4Indices(const u8 *v, u8 r0, u8 r1, u64 &indices) {
+
+		u8 pal[8];
+		bc4Palette(r0, r1, pal);
+
+		u64 error{};
+		indices = 0;
+
+		#ifdef IGNIS_COMPRESS_SSE
+
+			//8 texels per register; the squared error fits in a u16, which is compared signed after flipping the sign bit
+
+			const __m128i flip = _mm_set1_epi16(i16(0x8000));
+
+			for (usz h = 0; h < 16; h += 8) {
+
+				__m128i texels = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(v + h)), _mm_setzero_si128());
+				__m128i bestError = _mm_set1_epi16(i16(0x7FFF)), best = _mm_setzero_si128();
+
+				for (u16 j = 0; j < 8; ++j) {
+
+					__m128i d = _mm_sub_epi16(texels, _mm_set1_epi16(pal[j]));
+					__m128i e = _mm_xor_si128(_mm_mullo_epi16(d, d), flip);
+					__m128i lt = _mm_cmplt_epi16(e, bestError);
+
+					bestError = _mm_or_si128(_mm_and_si128(lt, e), _mm_andnot_si128(lt, bestError));
+					best = _mm_or_si128(_mm_and_si128(lt, _mm_set1_epi16(i16(j))), _mm_andnot_si128(lt, best));
+				}
+
+				alignas(16) u16 errors[8], ids[8];
+				_mm_store_si128((__m128i*)errors, _mm_xor_si128(bestError, flip));
+				_mm_store_si128((__m128i*)ids, best);
+
+				for (usz i = 0; i < 8; ++i) {
+					error += errors[i];
+					indices |= u64(ids[i]) << ((h + i) * 3);
+				}
+			}
+
+		#else
+
+			for (usz i = 0; i < 16; ++i) {
+
+				u64 best{};
+				i32 bestError = i32_MAX;
+
+				for (u32 j = 0; j < 8; ++j) {
+
+					i32 d = i32(v[i]) - pal[j];
+
+					if (d * d < bestError) {
+						bestError = d * d;
+						best = j;
+					}
+				}
+
+				error += u64(bestError);
+				indices |= best << (i * 3);
+			}
+
+		#endif
+
+		return error;
+	}
+
+	static void encodeBC4(const u8 *v, CompressionQuality quality, u8 *dst) {
+
+		u8 lo = 255, hi = 0;
+
+		for (usz i = 0; i < 16; ++i) {
+			lo = std::min(lo, v[i]);
+			hi = std::max(hi, v[i]);
+		}
+
+		u8 r0 = hi, r1 = lo;
+		u64 indices{};
+		u64 error = bc4Indices(v, r0, r1, indices);
+
+		//Blocks with exact 0 or 255 might be better off with the 6 value mode
+
+		if (quality == CompressionQuality::HIGH && error) {
+
+			u8 lo6 = 255, hi6 = 0;
+
+			for (usz i = 0; i < 16; ++i)
+				if (v[i] != 0 && v[i] != 255) {
+					lo6 = std::min(lo6, v[i]);
+					hi6 = std::max(hi6, v[i]);
+				}
+
+			if (lo6 <= hi6 && (lo == 0 || hi == 255)) {
+
+				u64 indices6;
+				u64 error6 = bc4Indices(v, lo6, hi6, indices6);
+
+				if (error6 < error) {
+					r0 = lo6;
+					r1 = hi6;
+					indices = indices6;
+				}
+			}
+		}
+
+		dst[0] = r0;
+		dst[1] = r1;
+
+		for (usz i = 0; i < 6; ++i)
+			dst[2 + i] = u8(indices >> (i * 8));
+	}
+
+	//BC7 mode 6; a single subset with 7 bit RGBA endpoints, a p-bit each and 4 bit indices
+
+	static constexpr u32 bc7Weights[] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	struct BC7Endpoints {
+		u8 c[2][4];		//7 bit
+		u8 p[2];
+	};
+
+	static void bc7Quantize(const f32 *e, u8 p, u8 *c) {
+		for (usz k = 0; k < 4; ++k)
+			c[k] = u8(std::clamp(std::round((e[k] - p) / 2), 0.f, 127.f));
+	}
+
+	static f32 bc7QuantizationError(const f32 *e, u8 p) {
+
+		u8 c[4];
+		bc7Quantize(e, p, c);
+
+		f32 err{};
+
+		for (usz k = 0; k < 4; ++k) {
+			f32 d = e[k] - f32((c[k] << 1) | p);
+			err += d * d;
+		}
+
+		return err;
+	}
+
+	static u64 bc7Indices(const BlockTexels &px, const BC7Endpoints &ep, u8 *indices) {
+
+		i32 e[2][4];
+
+		for (usz j = 0; j < 2; ++j)
+			for (usz k = 0; k < 4; ++k)
+				e[j][k] = (ep.c[j][k] << 1) | ep.p[j];
+
+		i32 pal[16][4];
+
+		for (usz i = 0; i < 16; ++i)
+			for (usz k = 0; k < 4; ++k)
+				pal[i][k] = (i32(64 - bc7Weights[i]) * e[0][k] + i32(bc7Weights[i]) * e[1][k] + 32) >> 6;
+
+		u64 error{};
+
+		#ifdef IGNIS_COMPRESS_SSE
+
+			//4 palette entries per register, as interleaved (r, g) and (b, a) pairs
+
+			__m128i palRG[4], palBA[4];
+
+			for (usz q = 0; q < 4; ++q) {
+
+				alignas(16) i16 rg[8], ba[8];
+
+				for (usz l = 0; l < 4; ++l) {
+					const i32 *c = pal[q * 4 + l];
+					rg[l * 2] = i16(c[0]);		rg[l * 2 + 1] = i16(c[1]);
+					ba[l * 2] = i16(c[2]);		ba[l * 2 + 1] = i16(c[3]);
+				}
+
+				palRG[q] = _mm_load_si128((const __m128i*)rg);
+				palBA[q] = _mm_load_si128((const __m128i*)ba);
+			}
+
+			//The error is shifted up, so the minimum also holds the first index with that error
+
+			const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+
+			for (usz i = 0; i < 16; ++i) {
+
+				__m128i rg = _mm_set1_epi32(i32(px[i][0] | (u32(px[i][1]) << 16)));
+				__m128i ba = _mm_set1_epi32(i32(px[i][2] | (u32(px[i][3]) << 16)));
+
+				__m128i best = _mm_set1_epi32(i32_MAX);
+
+				for (usz q = 0; q < 4; ++q) {
+					__m128i key = _mm_slli_epi32(blockDistance(rg, ba, palRG[q], palBA[q]), 4);
+					best = blockMin(best, _mm_or_si128(key, _mm_or_si128(lanes, _mm_set1_epi32(i32(q * 4)))));
+				}
+
+				i32 m = blockHorizontalMin(best);
+
+				indices[i] = u8(m & 15);
+				error += u64(m >> 4);
+			}
+
+		#else
+
+			for (usz i = 0; i < 16; ++i) {
+
+				i32 bestError = i32_MAX;
+
+				for (u8 j = 0; j < 16; ++j) {
+
+					i32 err{};
+
+					for (usz k = 0; k < 4; ++k) {
+						i32 d = i32(px[i][k]) - pal[j][k];
+						err += d * d;
+					}
+
+					if (err < bestError) {
+						bestError = err;
+						indices[i] = j;
+					}
+				}
+
+				error += u64(bestError);
+			}
+
+		#endif
+
+		return error;
+	}
+
+	//Try every p-bit combination (HIGH) or the p-bits closest to the endpoints
+
+	static u64 bc7Encode(const BlockTexels &px, const f32 *e0, const f32 *e1, bool searchPBits, BC7Endpoints &ep, u8 *indices) {
+
+		if (!searchPBits) {
+
+			ep.p[0] = bc7QuantizationError(e0, 1) < bc7QuantizationError(e0, 0);
+			ep.p[1] = bc7QuantizationError(e1, 1) < bc7QuantizationError(e1, 0);
+
+			bc7Quantize(e0, ep.p[0], ep.c[0]);
+			bc7Quantize(e1, ep.p[1], ep.c[1]);
+
+			return bc7Indices(px, ep, indices);
+		}
+
+		u64 best = u64_MAX;
+
+		for (u8 p = 0; p < 4; ++p) {
+
+			BC7Endpoints cur;
+			u8 curIndices[16];
+
+			cur.p[0] = p & 1;
+			cur.p[1] = p >> 1;
+
+			bc7Quantize(e0, cur.p[0], cur.c[0]);
+			bc7Quantize(e1, cur.p[1], cur.c[1]);
+
+			u64 err = bc7Indices(px, cur, curIndices);
+
+			if (err < best) {
+				best = err;
+				ep = cur;
+				std::memcpy(indices, curIndices, 16);
+			}
+		}
+
+		return best;
+	}
+
+	static void encodeBC7(const BlockTexels &px, CompressionQuality quality, u8 *dst) {
+
+		f32 e0[4], e1[4];
+		fitEndpoints(px, 4, nullptr, quality, e0, e1);
+
+		bool high = quality == CompressionQuality::HIGH;
+
+		BC7Endpoints ep;
+		u8 indices[16];
+		u64 error = bc7Encode(px, e0, e1, high, ep, indices);
+
+		if (high)
+			for (u32 it = 0; it < 2 && error; ++it) {
+
+				f32 weights[16];
+
+				for (usz i = 0; i < 16; ++i)
+					weights[i] = bc7Weights[indices[i]] / 64.f;
+
+				if (!refineEndpoints(px, 4, nullptr, weights, e0, e1))
+					break;
+
+				BC7Endpoints nEp;
+				u8 nIndices[16];
+				u64 nError = bc7Encode(px, e0, e1, true, nEp, nIndices);
+
+				if (nError >= error)
+					break;
+
+				error = nError;
+				ep = nEp;
+				std::memcpy(indices, nIndices, 16);
+			}
+
+		//The anchor index has an implicit 0 msb
+
+		if (indices[0] & 8) {
+
+			std::swap(ep.p[0], ep.p[1]);
+
+			for (usz k = 0; k < 4; ++k)
+				std::swap(ep.c[0][k], ep.c[1][k]);
+
+			for (usz i = 0; i < 16; ++i)
+				indices[i] = 15 - indices[i];
+		}
+
+		//Write the bits from lsb to msb
+
+		u64 bits[2]{};
+		u32 pos{};
+
+		auto write = [&bits, &pos](u64 v, u32 count) {
+			for (u32 i = 0; i < count; ++i, ++pos)
+				bits[pos >> 6] |= ((v >> i) & 1) << (pos & 63);
+		};
+
+		write(1 << 6, 7);
+
+		for (usz k = 0; k < 4; ++k) {
+			write(ep.c[0][k], 7);
+			write(ep.c[1][k], 7);
+		}
+
+		write(ep.p[0], 1);
+		write(ep.p[1], 1);
+
+		write(indices[0], 3);
+
+		for (usz i = 1; i < 16; ++i)
+			write(indices[i], 4);
+
+		std::memcpy(dst, bits, 16);
+	}
+
+	//Encode all mips
+
+	bool Texture::Info::compress(GPUFormat target, CompressionQuality quality) {
+
+		GPUFormat source;
+
+		switch (target.value) {
+
+			case GPUFormat::bc1:		case GPUFormat::bc7:		source = GPUFormat::rgba8;	break;
+			case GPUFormat::bc1srgb:	case GPUFormat::bc7srgb:	source = GPUFormat::srgba8;	break;
+			case GPUFormat::bc4:		source = GPUFormat::r8;		break;
+			case GPUFormat::bc5:		source = GPUFormat::rg8;	break;
+
+			default:
+				oic::System::log()->error("Texture::Info::compress only supports bc1, bc4, bc5 and bc7");
+				return false;
+		}
+
+		//Data in another format is converted to the format the encoder expects first
+
+		if (FormatHelper::isCompressed(format) || !FormatConverter::canConvert(getDataFormat(), source)) {
+			oic::System::log()->error("Texture::Info::compress has an incompatible source format");
+			return false;
+		}
+
+		auto dim = textureType & TextureType::PROPERTY_DIMENSION;
+
+		if (
+			(dim != TextureType::TEXTURE_2D && dim != TextureType::TEXTURE_CUBE) ||
+			samples > 1 || HasFlags(usage, GPUMemoryUsage::GPU_WRITE)
+		) {
+			oic::System::log()->error("Texture::Info::compress requires a 2D or cube texture that isn't GPU writable");
+			return false;
+		}
+
+		layout();
+
+		if (!hasData()) {
+			oic::System::log()->error("Texture::Info::compress requires all mips");
+			return false;
+		}
+
+		if (getDataFormat() != source || swapRB) {
+
+			GPUFormat original = format;
+			format = source;
+
+			if (!convert(source)) {
+				format = original;
+				return false;
+			}
+		}
+
+		format = source;
+		dataFormat = GPUFormat::NONE;
+
+		const usz channels = FormatHelper::getChannelCount(format);
+		const usz blockBytes = FormatHelper::getBlockBytes(target);
+
+		//Encode every mip into one allocation with the layout of the target
+
+		List<Subresource> sourceLayout = subresources;
+
+		format = target;
+		Buffer compressed(layout());
+
+		for (u8 m = 0; m < mips; ++m) {
+
+			//The layers of cube and array textures are stored in mipSizes[m].z, but encoded separately
+
+			const usz w = mipSizes[m].x, h = mipSizes[m].y, slices = layers > 1 ? 1 : mipSizes[m].z;
+			const usz blocksX = (w + 3) / 4, blocksY = (h + 3) / 4;
+
+			//Every block row of every layer (cube face or array layer) can be encoded independently
+
+			const usz rows = blocksY * slices;
+
+			//A row encodes blocksX blocks of 16 texels, at roughly 16 units of work per texel;
+			//so small mips are encoded on the calling thread
+
+			parallelFor(rows * layers, std::max(parallelMinItems(blocksX * 16 * 16), usz(4)), [&](usz job) {
+
+				const usz layer = job / rows, row = job % rows;
+				const usz slice = row / blocksY, by = row % blocksY;
+
+				const u8 *src = initData.data() + sourceLayout[usz(m) * layers + layer].offset;
+				u8 *dst = compressed.data() + getSubresource(m, u16(layer)).offset;
+
+				const u8 *slicePtr = src + slice * w * h * channels;
+
+				for (usz bx = 0; bx < blocksX; ++bx) {
+
+					//Gather the block; edges are clamped
+
+					BlockTexels px;
+
+					for (usz i = 0; i < 16; ++i) {
+
+						usz x = std::min(bx * 4 + (i & 3), w - 1);
+						usz y = std::min(by * 4 + (i >> 2), h - 1);
+
+						const u8 *t = slicePtr + (y * w + x) * channels;
+
+						for (usz c = 0; c < 4; ++c)
+							px[i][c] = c < channels ? t[c] : (c == 3 ? 255 : 0);
+					}
+
+					u8 *out = dst + (row * blocksX + bx) * blockBytes;
+
+					switch (target.value) {
+
+						case GPUFormat::bc1:
+						case GPUFormat::bc1srgb:
+							encodeBC1(px, quality, out);
+							break;
+
+						case GPUFormat::bc4:
+						case GPUFormat::bc5: {
+
+							for (usz c = 0; c < channels; ++c) {
+
+								u8 v[16];
+
+								for (usz i = 0; i < 16; ++i)
+									v[i] = px[i][c];
+
+								encodeBC4(v, quality, out + c * 8);
+							}
+
+							break;
+						}
+
+						default:
+							encodeBC7(px, quality, out);
+					}
+				}
+			});
+		}
+
+		initData.swap(compressed);
+		return true;
+	}
+
+}
@@ -0,0 +1,1693 @@
+#include "graphics/memory/texture_file.hpp"
+#include "graphics/memory/mapped_file.hpp"
+#include "system/log.hpp"
+#include "system/system.hpp"
+#include <cstring>
+#include <bit>
+
+namespace ignis {
+
+	template<typename T>
+	static inline T readLE(const u8 *ptr) {
+		T t;
+		std::memcpy(&t, ptr, sizeof(T));
+		return t;
+	}
+
+	//Minimal zlib (RFC 1950/1951) decoder for supercompressed KTX2
+
+	struct Inflate {
+
+		const u8 *src;
+		usz srcSize, srcPos{};
+
+		u8 *dst;
+		usz dstSize, dstPos{};
+
+		u32 bitBuffer{}, bitCount{};
+		bool error{};
+
+		struct Huffman {
+			u16 count[16];
+			u16 symbol[288];
+		};
+
+		u32 bits(u32 n) {
+
+			while (bitCount < n) {
+
+				if (srcPos >= srcSize) {
+					error = true;
+					return 0;
+				}
+
+				bitBuffer |= u32(src[srcPos++]) << bitCount;
+				bitCount += 8;
+			}
+
+			u32 v = bitBuffer & ((1u << n) - 1);
+			bitBuffer >>= n;
+			bitCount -= n;
+			return v;
+		}
+
+		static bool build(Huffman &h, const u8 *lengths, usz n) {
+
+			std::memset(h.count, 0, sizeof(h.count));
+
+			for (usz i = 0; i < n; ++i)
+				++h.count[lengths[i]];
+
+			if (h.count[0] == n)
+				return true;
+
+			//Over subscribed codes are invalid, incomplete codes are allowed
+
+			i32 left = 1;
+
+			for (usz len = 1; len < 16; ++len) {
+
+				left = (left << 1) - h.count[len];
+
+				if (left < 0)
+					return false;
+			}
+
+			u16 offsets[16];
+			offsets[1] = 0;
+
+			for (usz len = 1; len < 15; ++len)
+				offsets[len + 1] = offsets[len] + h.count[len];
+
+			for (usz i = 0; i < n; ++i)
+				if (lengths[i])
+					h.symbol[offsets[lengths[i]]++] = u16(i);
+
+			return true;
+		}
+
+		i32 decode(const Huffman &h) {
+
+			i32 code{}, first{}, index{};
+
+			for (usz len = 1; len < 16; ++len) {
+
+				code |= i32(bits(1));
+
+				i32 count = h.count[len];
+
+				if (code - count < first)
+					return h.symbol[index + (code - first)];
+
+				index += count;
+				first = (first + count) << 1;
+				code <<= 1;
+			}
+
+			error = true;
+			return -1;
+		}
+
+		bool codes(const Huffman &lengthCodes, const Huffman &distCodes) {
+
+			static constexpr u16 lengthBase[] = {
+				3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+				35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+			};
+
+			static constexpr u8 lengthExtra[] = {
+				0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+				3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+			};
+
+			static constexpr u16 distBase[] = {
+				1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+				257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+			};
+
+			static constexpr u8 distExtra[] = {
+				0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+				7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+			};
+
+			while (!error) {
+
+				i32 symbol = decode(lengthCodes);
+
+				if (symbol < 0)
+					return false;
+
+				if (symbol < 256) {
+
+					if (dstPos >= dstSize)
+						return false;
+
+					dst[dstPos++] = u8(symbol);
+					continue;
+				}
+
+				if (symbol == 256)
+					return true;
+
+				symbol -= 257;
+
+				if (symbol >= 29)
+					return false;
+
+				usz len = lengthBase[symbol] + bits(lengthExtra[symbol]);
+
+				i32 distSymbol = decode(distCodes);
+
+				if (distSymbol < 0 || distSymbol >= 30)
+					return false;
+
+				usz dist = distBase[distSymbol] + bits(distExtra[distSymbol]);
+
+				if (dist > dstPos || dstPos + len > dstSize)
+					return false;
+
+				for (usz i = 0; i < len; ++i, ++dstPos)
+					dst[dstPos] = dst[dstPos - dist];
+			}
+
+			return false;
+		}
+
+		bool stored() {
+
+			bitBuffer = bitCount = 0;
+
+			if (srcPos + 4 > srcSize)
+				return false;
+
+			u16 len = readLE<u16>(src + srcPos);
+			u16 nlen = readLE<u16>(src + srcPos + 2);
+			srcPos += 4;
+
+			if (u16(~nlen) != len || srcPos + len > srcSize || dstPos + len > dstSize)
+				return false;
+
+			std::memcpy(dst + dstPos, src + srcPos, len);
+			srcPos += len;
+			dstPos += len;
+			return true;
+		}
+
+		bool fixed() {
+
+			static const auto tables = []() {
+
+				Pair<Huffman, Huffman> res;
+				u8 lengths[288];
+
+				for (usz i = 0; i < 288; ++i)
+					lengths[i] = i < 144 ? 8 : (i < 256 ? 9 : (i < 280 ? 7 : 8));
+
+				build(res.first, lengths, 288);
+
+				for (usz i = 0; i < 30; ++i)
+					lengths[i] = 5;
+
+				build(res.second, lengths, 30);
+				return res;
+			}();
+
+			return codes(tables.first, tables.second);
+		}
+
+		bool dynamic() {
+
+			static constexpr u8 order[] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+			usz lengthCount = bits(5) + 257_usz, distCount = bits(5) + 1_usz, codeCount = bits(4) + 4_usz;
+
+			if (lengthCount > 286 || distCount > 30)
+				return false;
+
+			u8 lengths[320]{};
+
+			for (usz i = 0; i < codeCount; ++i)
+				lengths[order[i]] = u8(bits(3));
+
+			Huffman lengthCodes, distCodes;
+
+			if (!build(lengthCodes, lengths, 19))
+				return false;
+
+			for (usz i = 0; i < lengthCount + distCount; ) {
+
+				i32 symbol = decode(lengthCodes);
+
+				if (symbol < 0 || error)
+					return false;
+
+				if (symbol < 16) {
+					lengths[i++] = u8(symbol);
+					continue;
+				}
+
+				u8 value{};
+				usz repeat;
+
+				if (symbol == 16) {
+
+					if (!i)
+						return false;
+
+					value = lengths[i - 1];
+					repeat = 3 + bits(2);
+				}
+
+				else if (symbol == 17)
+					repeat = 3 + bits(3);
+
+				else repeat = 11 + bits(7);
+
+				if (i + repeat > lengthCount + distCount)
+					return false;
+
+				while (repeat--)
+					lengths[i++] = value;
+			}
+
+			if (!lengths[256])
+				return false;
+
+			if (!build(lengthCodes, lengths, lengthCount) || !build(distCodes, lengths + lengthCount, distCount))
+				return false;
+
+			return codes(lengthCodes, distCodes);
+		}
+
+		bool run() {
+
+			//zlib header; deflate without a preset dictionary
+
+			if (srcSize < 2 || (src[0] & 0xF) != 8 || ((u32(src[0]) << 8) | src[1]) % 31 || (src[1] & 0x20))
+				return false;
+
+			srcPos = 2;
+
+			for (u32 last{}; !last; ) {
+
+				last = bits(1);
+
+				bool ok;
+
+				switch (bits(2)) {
+					case 0:		ok = stored();	break;
+					case 1:		ok = fixed();	break;
+					case 2:		ok = dynamic();	break;
+					default:	ok = false;
+				}
+
+				if (!ok || error)
+					return false;
+			}
+
+			return dstPos == dstSize;
+		}
+	};
+
+	//Minimal Zstandard (RFC 8878) decoder for supercompressed KTX2; dictionaries aren't supported
+	//The content checksum isn't verified
+
+	struct Zstd {
+
+		const u8 *src;
+		usz srcSize;
+
+		u8 *dst;
+		usz dstSize, dstPos{};
+
+		//Bits read from the end of a stream to its start; the last byte is padded up to its highest set bit
+		//Bits before the start of the stream are read as zeros
+
+		struct ReverseBits {
+
+			const u8 *src{};
+			usz size{};
+			i64 pos{};
+
+			bool init(const u8 *ptr, usz n) {
+
+				if (!n || !ptr[n - 1])
+					return false;
+
+				src = ptr;
+				size = n;
+				pos = i64(n - 1) * 8 + 31 - std::countl_zero(u32(ptr[n - 1]));
+				return true;
+			}
+
+			u64 at(u64 start, u32 n) const {
+
+				if (!n)
+					return 0;
+
+				usz byte = usz(start >> 3);
+				u64 v{};
+				std::memcpy(&v, src + byte, std::min(usz(8), size - byte));
+				return (v >> (start & 7)) & ((1_u64 << n) - 1);
+			}
+
+			u64 peek(u32 n) const {
+
+				i64 start = pos - n;
+
+				if (start >= 0)
+					return at(u64(start), n);
+
+				return i64(n) + start > 0 ? at(0, u32(i64(n) + start)) << u32(-start) : 0;
+			}
+
+			u64 read(u32 n) {
+				u64 v = peek(n);
+				pos -= n;
+				return v;
+			}
+		};
+
+		struct FSETable {
+
+			struct Entry {
+				u16 base;
+				u8 symbol, bits;
+			};
+
+			Entry entries[512];
+			u8 log{};
+			bool valid{};
+		};
+
+		struct HuffmanTable {
+
+			struct Entry {
+				u8 symbol, bits;
+			};
+
+			Entry entries[1 << 11];
+			u8 log{};
+			bool valid{};
+		};
+
+		//Baselines and extra bits of the literal and match length codes
+
+		static constexpr u32 llBase[36] = {
+			0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+			16, 18, 20, 22, 24, 28, 32, 40, 48, 64, 128, 256, 512, 1024, 2048, 4096,
+			8192, 16384, 32768, 65536
+		};
+
+		static constexpr u8 llBits[36] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			1, 1, 1, 1, 2, 2, 3, 3, 4, 6, 7, 8, 9, 10, 11, 12,
+			13, 14, 15, 16
+		};
+
+		static constexpr u32 mlBase[53] = {
+			3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+			19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34,
+			35, 37, 39, 41, 43, 47, 51, 59, 67, 83, 99, 131, 259, 515, 1027, 2051,
+			4099, 8195, 16387, 32771, 65539
+		};
+
+		static constexpr u8 mlBits[53] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			1, 1, 1, 1, 2, 2, 3, 3, 4, 4, 5, 7, 8, 9, 10, 11,
+			12, 13, 14, 15, 16
+		};
+
+		//Predefined distributions
+
+		static constexpr i16 llDefault[36] = {
+			4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1,
+			2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1,
+			-1, -1, -1, -1
+		};
+
+		static constexpr i16 mlDefault[53] = {
+			1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+			1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+			1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1,
+			-1, -1, -1, -1, -1
+		};
+
+		static constexpr i16 ofDefault[29] = {
+			1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+			1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1
+		};
+
+		//State of the frame; tables can be repeated by the next blocks
+
+		FSETable llTable{}, ofTable{}, mlTable{};
+		HuffmanTable huffman{};
+
+		u32 rep[3]{};
+		usz frameStart{};
+
+		Buffer literals{};
+
+		static inline u32 highBit(u32 v) { return 31 - u32(std::countl_zero(v)); }
+
+		//Spread the symbols over the states of the table
+
+		static bool buildFSE(FSETable &table, const i16 *norm, u32 symbols, u32 log) {
+
+			const u32 size = 1u << log;
+			u32 high = size - 1;
+
+			u16 next[53];
+
+			for (u32 s = 0; s < symbols; ++s)
+				if (norm[s] == -1) {
+					table.entries[high--].symbol = u8(s);
+					next[s] = 1;
+				}
+
+				else next[s] = u16(norm[s]);
+
+			const u32 step = (size >> 1) + (size >> 3) + 3;
+			u32 pos{};
+
+			for (u32 s = 0; s < symbols; ++s)
+				for (i32 i = 0; i < norm[s]; ++i) {
+
+					table.entries[pos].symbol = u8(s);
+
+					do pos = (pos + step) & (size - 1);
+					while (pos > high);
+				}
+
+			if (pos)
+				return false;
+
+			for (u32 i = 0; i < size; ++i) {
+
+				auto &entry = table.entries[i];
+
+				u32 state = next[entry.symbol]++;
+				entry.bits = u8(log - highBit(state));
+				entry.base = u16((state << entry.bits) - size);
+			}
+
+			table.log = u8(log);
+			table.valid = true;
+			return true;
+		}
+
+		//Read the normalized distribution of a table; returns the bytes that were read or 0
+
+		static usz readFSE(const u8 *ptr, usz size, i16 *norm, u32 maxSymbol, u32 maxLog, u32 &log, u32 &symbols) {
+
+			u64 bit{};
+			const u64 bitEnd = u64(size) * 8;
+
+			auto read = [&](u32 n, bool consume) -> u32 {
+
+				u32 v{};
+
+				for (u32 i = 0; i < n; ++i) {
+
+					u64 b = bit + i;
+
+					if (b < bitEnd)
+						v |= u32((ptr[b >> 3] >> (b & 7)) & 1) << i;
+				}
+
+				if (consume)
+					bit += n;
+
+				return v;
+			};
+
+			log = read(4, true) + 5;
+
+			if (log > maxLog)
+				return 0;
+
+			i32 remaining = (1 << log) + 1;
+			i32 threshold = 1 << log;
+			u32 nbBits = log + 1, s{};
+
+			bool previous0{};
+
+			while (remaining > 1 && s <= maxSymbol) {
+
+				//Zero probabilities are followed by the number of symbols that repeat it
+
+				if (previous0) {
+
+					u32 repeat;
+
+					do {
+
+						repeat = read(2, true);
+
+						for (u32 i = 0; i < repeat; ++i) {
+
+							if (s > maxSymbol)
+								return 0;
+
+							norm[s++] = 0;
+						}
+					}
+					while (repeat == 3);
+
+					if (s > maxSymbol)
+						return 0;
+				}
+
+				i32 max = (2 * threshold - 1) - remaining;
+				i32 count = i32(read(nbBits, false));
+
+				if ((count & (threshold - 1)) < max) {
+					count &= threshold - 1;
+					bit += nbBits - 1;
+				}
+
+				else {
+
+					count &= 2 * threshold - 1;
+
+					if (count >= threshold)
+						count -= max;
+
+					bit += nbBits;
+				}
+
+				--count;
+				remaining -= count < 0 ? -count : count;
+				norm[s++] = i16(count);
+				previous0 = !count;
+
+				while (remaining < threshold) {
+					--nbBits;
+					threshold >>= 1;
+				}
+			}
+
+			if (remaining != 1 || bit > bitEnd)
+				return 0;
+
+			symbols = s;
+			return usz((bit + 7) >> 3);
+		}
+
+		//Huffman tree description; returns the bytes that were read or 0
+
+		usz readHuffman(const u8 *ptr, usz size) {
+
+			if (!size)
+				return 0;
+
+			u8 weights[256]{};
+			u32 count{};
+			usz read;
+
+			u32 header = ptr[0];
+
+			//Weights as 4 bits each
+
+			if (header >= 128) {
+
+				count = header - 127;
+				read = 1 + (count + 1) / 2;
+
+				if (read > size)
+					return 0;
+
+				for (u32 i = 0; i < count; ++i)
+					weights[i] = i & 1 ? ptr[1 + i / 2] & 0xF : ptr[1 + i / 2] >> 4;
+			}
+
+			//FSE compressed weights with two interleaved states
+
+			else {
+
+				read = 1 + header;
+
+				if (read > size || !header)
+					return 0;
+
+				i16 norm[53]{};
+				u32 log, symbols;
+				usz tableSize = readFSE(ptr + 1, header, norm, 12, 6, log, symbols);
+
+				FSETable table;
+
+				if (!tableSize || tableSize >= header || !buildFSE(table, norm, symbols, log))
+					return 0;
+
+				ReverseBits bits;
+
+				if (!bits.init(ptr + 1 + tableSize, header - tableSize))
+					return 0;
+
+				u32 state[2] = { u32(bits.read(log)), u32(bits.read(log)) };
+
+				for (u32 i = 0; ; i ^= 1) {
+
+					if (count >= 255)
+						return 0;
+
+					auto &entry = table.entries[state[i]];
+					weights[count++] = entry.symbol;
+					state[i] = entry.base + u32(bits.read(entry.bits));
+
+					if (bits.pos < 0) {
+						weights[count++] = table.entries[state[i ^ 1]].symbol;
+						break;
+					}
+				}
+			}
+
+			//The weight of the last symbol is implied; it completes the tree
+
+			u32 rankCount[13]{}, total{};
+
+			for (u32 i = 0; i < count; ++i) {
+
+				if (weights[i] > 11)
+					return 0;
+
+				++rankCount[weights[i]];
+				total += (1u << weights[i]) >> 1;
+			}
+
+			if (!total)
+				return 0;
+
+			u32 log = highBit(total) + 1;
+			u32 rest = (1u << log) - total;
+
+			if (log > 11 || rest & (rest - 1))
+				return 0;
+
+			u32 last = highBit(rest) + 1;
+			weights[count++] = u8(last);
+			++rankCount[last];
+
+			//Longer codes first, symbols in order within a length
+
+			u32 rankStart[13]{}, next{};
+
+			for (u32 w = 1; w <= log; ++w) {
+				rankStart[w] = next;
+				next += rankCount[w] << (w - 1);
+			}
+
+			for (u32 s = 0; s < count; ++s) {
+
+				u32 w = weights[s];
+
+				if (!w)
+					continue;
+
+				for (u32 i = 0, j = 1u << (w - 1); i < j; ++i)
+					huffman.entries[rankStart[w] + i] = { u8(s), u8(log + 1 - w) };
+
+				rankStart[w] += 1u << (w - 1);
+			}
+
+			huffman.log = u8(log);
+			huffman.valid = true;
+			return read;
+		}
+
+		bool decodeHuffman(const u8 *ptr, usz size, u8 *out, usz count) {
+
+			ReverseBits bits;
+
+			if (!bits.init(ptr, size))
+				return false;
+
+			for (usz i = 0; i < count; ++i) {
+				auto &entry = huffman.entries[bits.peek(huffman.log)];
+				out[i] = entry.symbol;
+				bits.pos -= entry.bits;
+			}
+
+			return bits.pos == 0;
+		}
+
+		//Literals are either referenced from the block or decoded into the literal buffer
+
+		usz readLiterals(const u8 *ptr, usz size, const u8 *&lit, usz &litSize) {
+
+			if (!size)
+				return 0;
+
+			u32 type = ptr[0] & 3, format = (ptr[0] >> 2) & 3;
+
+			if (type < 2) {
+
+				usz header;
+
+				switch (format) {
+					case 1:		header = 2;		litSize = (ptr[0] >> 4) | (usz(size > 1 ? ptr[1] : 0) << 4);	break;
+					case 3:		header = 3;		litSize = (ptr[0] >> 4) | (usz(size > 1 ? ptr[1] : 0) << 4) | (usz(size > 2 ? ptr[2] : 0) << 12);	break;
+					default:	header = 1;		litSize = ptr[0] >> 3;
+				}
+
+				if (header > size)
+					return 0;
+
+				if (type == 0) {
+
+					if (header + litSize > size)
+						return 0;
+
+					lit = ptr + header;
+					return header + litSize;
+				}
+
+				if (header + 1 > size)
+					return 0;
+
+				literals.resize(litSize);
+				std::memset(literals.data(), ptr[header], litSize);
+				lit = literals.data();
+				return header + 1;
+			}
+
+			//Huffman compressed (type 3 reuses the previous tree)
+
+			static constexpr u8 headerSizes[] = { 3, 3, 4, 5 };
+			static constexpr u8 sizeBits[] = { 10, 10, 14, 18 };
+
+			usz header = headerSizes[format];
+
+			if (header > size)
+				return 0;
+
+			u64 value{};
+			std::memcpy(&value, ptr, header);
+
+			litSize = usz(value >> 4) & ((1_usz << sizeBits[format]) - 1);
+			usz compressed = usz(value >> (4 + sizeBits[format])) & ((1_usz << sizeBits[format]) - 1);
+
+			if (header + compressed > size)
+				return 0;
+
+			const u8 *stream = ptr + header;
+			usz streamSize = compressed;
+
+			if (type == 2) {
+
+				usz tree = readHuffman(stream, streamSize);
+
+				if (!tree)
+					return 0;
+
+				stream += tree;
+				streamSize -= tree;
+			}
+
+			else if (!huffman.valid)
+				return 0;
+
+			literals.resize(litSize);
+			lit = literals.data();
+
+			if (!format) {
+
+				if (!decodeHuffman(stream, streamSize, literals.data(), litSize))
+					return 0;
+			}
+
+			//Four streams after a jump table
+
+			else {
+
+				if (streamSize < 6)
+					return 0;
+
+				usz sizes[4] = { readLE<u16>(stream), readLE<u16>(stream + 2), readLE<u16>(stream + 4), 0 };
+				usz used = 6 + sizes[0] + sizes[1] + sizes[2];
+
+				if (used > streamSize)
+					return 0;
+
+				sizes[3] = streamSize - used;
+
+				usz quarter = (litSize + 3) / 4;
+
+				if (quarter * 3 > litSize)
+					return 0;
+
+				const u8 *s = stream + 6;
+
+				for (usz i = 0; i < 4; ++i) {
+
+					usz count = i < 3 ? quarter : litSize - quarter * 3;
+
+					if (!decodeHuffman(s, sizes[i], literals.data() + quarter * i, count))
+						return 0;
+
+					s += sizes[i];
+				}
+			}
+
+			return header + compressed;
+		}
+
+		bool sequenceTable(
+			u32 mode, FSETable &table, const i16 *predefined, u32 predefinedSymbols, u32 predefinedLog,
+			u32 maxSymbol, u32 maxLog, const u8 *&ptr, const u8 *end
+		) {
+
+			switch (mode) {
+
+				case 0:
+					return buildFSE(table, predefined, predefinedSymbols, predefinedLog);
+
+				case 1:
+
+					if (ptr >= end || *ptr > maxSymbol)
+						return false;
+
+					table.entries[0] = { 0, *ptr++, 0 };
+					table.log = 0;
+					table.valid = true;
+					return true;
+
+				case 2: {
+
+					i16 norm[53]{};
+					u32 log, symbols;
+					usz read = readFSE(ptr, usz(end - ptr), norm, maxSymbol, maxLog, log, symbols);
+
+					if (!read)
+						return false;
+
+					ptr += read;
+					return buildFSE(table, norm, symbols, log);
+				}
+
+				default:
+					return table.valid;
+			}
+		}
+
+		bool block(const u8 *ptr, usz size) {
+
+			const u8 *end = ptr + size;
+
+			const u8 *lit{};
+			usz litSize{};
+			usz read = readLiterals(ptr, size, lit, litSize);
+
+			if (!read)
+				return false;
+
+			ptr += read;
+
+			//Number of sequences
+
+			if (ptr >= end)
+				return false;
+
+			usz sequences = *ptr++;
+
+			if (sequences >= 128) {
+
+				if (ptr >= end)
+					return false;
+
+				if (sequences == 255) {
+
+					if (ptr + 2 > end)
+						return false;
+
+					sequences = readLE<u16>(ptr) + 0x7F00_usz;
+					ptr += 2;
+				}
+
+				else sequences = ((sequences - 128) << 8) | *ptr++;
+			}
+
+			usz litPos{};
+
+			if (sequences) {
+
+				if (ptr >= end)
+					return false;
+
+				u8 modes = *ptr++;
+
+				if (
+					(modes & 3) ||
+					!sequenceTable(modes >> 6, llTable, llDefault, 36, 6, 35, 9, ptr, end) ||
+					!sequenceTable((modes >> 4) & 3, ofTable, ofDefault, 29, 5, 31, 8, ptr, end) ||
+					!sequenceTable((modes >> 2) & 3, mlTable, mlDefault, 53, 6, 52, 9, ptr, end)
+				)
+					return false;
+
+				ReverseBits bits;
+
+				if (!bits.init(ptr, usz(end - ptr)))
+					return false;
+
+				u32 llState = u32(bits.read(llTable.log));
+				u32 ofState = u32(bits.read(ofTable.log));
+				u32 mlState = u32(bits.read(mlTable.log));
+
+				for (usz i = 0; i < sequences; ++i) {
+
+					auto &ll = llTable.entries[llState];
+					auto &of = ofTable.entries[ofState];
+					auto &ml = mlTable.entries[mlState];
+
+					if (of.symbol > 31)
+						return false;
+
+					//Extra bits are read for the offset, match length and then literal length
+
+					u32 offsetValue = u32((1_u64 << of.symbol) + bits.read(of.symbol));
+					usz matchLength = mlBase[ml.symbol] + usz(bits.read(mlBits[ml.symbol]));
+					usz literalLength = llBase[ll.symbol] + usz(bits.read(llBits[ll.symbol]));
+
+					//Offsets 1-3 repeat one of the previous offsets
+
+					u32 offset;
+
+					if (offsetValue > 3) {
+						offset = offsetValue - 3;
+						rep[2] = rep[1];
+						rep[1] = rep[0];
+						rep[0] = offset;
+					}
+
+					else {
+
+						u32 id = offsetValue - 1 + !literalLength;
+
+						if (!id)
+							offset = rep[0];
+
+						else {
+
+							offset = id == 3 ? rep[0] - 1 : rep[id];
+
+							if (id != 1)
+								rep[2] = rep[1];
+
+							rep[1] = rep[0];
+							rep[0] = offset;
+						}
+					}
+
+					//Copy the literals and then the match
+
+					if (
+						litPos + literalLength > litSize || 
+						dstPos + literalLength + matchLength > dstSize ||
+						!offset || offset > dstPos + literalLength - frameStart
+					)
+						return false;
+
+					std::memcpy(dst + dstPos, lit + litPos, literalLength);
+					litPos += literalLength;
+					dstPos += literalLength;
+
+					for (usz j = 0; j < matchLength; ++j, ++dstPos)
+						dst[dstPos] = dst[dstPos - offset];
+
+					//States are updated in the order literal length, match length and offset
+
+					if (i + 1 < sequences) {
+						llState = ll.base + u32(bits.read(ll.bits));
+						mlState = ml.base + u32(bits.read(ml.bits));
+						ofState = of.base + u32(bits.read(of.bits));
+					}
+				}
+
+				if (bits.pos)
+					return false;
+			}
+
+			else if (ptr != end)
+				return false;
+
+			//Remaining literals
+
+			usz rest = litSize - litPos;
+
+			if (dstPos + rest > dstSize)
+				return false;
+
+			std::memcpy(dst + dstPos, lit + litPos, rest);
+			dstPos += rest;
+			return true;
+		}
+
+		bool frame(usz &pos) {
+
+			if (pos + 5 > srcSize)
+				return false;
+
+			u8 descriptor = src[pos + 4];
+			pos += 5;
+
+			u32 contentSizeFlag = descriptor >> 6, dictFlag = descriptor & 3;
+			bool singleSegment = descriptor & 0x20, hasChecksum = descriptor & 4;
+
+			if (descriptor & 8)
+				return false;
+
+			static constexpr u8 dictSizes[] = { 0, 1, 2, 4 };
+			static constexpr u8 contentSizes[] = { 0, 2, 4, 8 };
+
+			usz dictSize = dictSizes[dictFlag];
+			usz contentSize = contentSizeFlag || !singleSegment ? contentSizes[contentSizeFlag] : 1;
+			usz header = !singleSegment + dictSize + contentSize;
+
+			if (pos + header > srcSize)
+				return false;
+
+			u32 dict{};
+			std::memcpy(&dict, src + pos + !singleSegment, dictSize);
+
+			if (dict)
+				return false;
+
+			pos += header;
+
+			//Tables and offsets don't carry over between frames
+
+			llTable.valid = ofTable.valid = mlTable.valid = huffman.valid = false;
+			rep[0] = 1;
+			rep[1] = 4;
+			rep[2] = 8;
+			frameStart = dstPos;
+
+			for (bool last{}; !last; ) {
+
+				if (pos + 3 > srcSize)
+					return false;
+
+				u32 blockHeader = u32(src[pos]) | (u32(src[pos + 1]) << 8) | (u32(src[pos + 2]) << 16);
+				pos += 3;
+
+				last = blockHeader & 1;
+				u32 type = (blockHeader >> 1) & 3;
+				usz size = blockHeader >> 3;
+
+				if (size > (1 << 17))
+					return false;
+
+				switch (type) {
+
+					case 0:
+
+						if (pos + size > srcSize || dstPos + size > dstSize)
+							return false;
+
+						std::memcpy(dst + dstPos, src + pos, size);
+						dstPos += size;
+						pos += size;
+						break;
+
+					case 1:
+
+						if (pos + 1 > srcSize || dstPos + size > dstSize)
+							return false;
+
+						std::memset(dst + dstPos, src[pos], size);
+						dstPos += size;
+						++pos;
+						break;
+
+					case 2:
+
+						if (pos + size > srcSize || !block(src + pos, size))
+							return false;
+
+						pos += size;
+						break;
+
+					default:
+						return false;
+				}
+			}
+
+			pos += hasChecksum ? 4 : 0;
+			return pos <= srcSize;
+		}
+
+		bool run() {
+
+			//Frames are decoded one after another; skippable frames are ignored
+
+			for (usz pos{}; pos < srcSize; ) {
+
+				if (pos + 8 > srcSize)
+					return false;
+
+				u32 magic = readLE<u32>(src + pos);
+
+				if ((magic & 0xFFFFFFF0) == 0x184D2A50)
+					pos += 8 + usz(readLE<u32>(src + pos + 4));
+
+				else if (magic != 0xFD2FB528 || !frame(pos))
+					return false;
+			}
+
+			return dstPos == dstSize;
+		}
+	};
+
+	//Format tables
+
+	static GPUFormat dxgiFormat(u32 format) {
+
+		switch (format) {
+
+			case 2:		return GPUFormat::rgba32f;
+			case 3:		return GPUFormat::rgba32u;
+			case 4:		return GPUFormat::rgba32i;
+			case 6:		return GPUFormat::rgb32f;
+			case 7:		return GPUFormat::rgb32u;
+			case 8:		return GPUFormat::rgb32i;
+			case 10:	return GPUFormat::rgba16f;
+			case 11:	return GPUFormat::rgba16;
+			case 12:	return GPUFormat::rgba16u;
+			case 13:	return GPUFormat::rgba16s;
+			case 14:	return GPUFormat::rgba16i;
+			case 16:	return GPUFormat::rg32f;
+			case 17:	return GPUFormat::rg32u;
+			case 18:	return GPUFormat::rg32i;
+			case 24:	return GPUFormat::rgb10a2;
+			case 25:	return GPUFormat::rgb10a2u;
+			case 26:	return GPUFormat::r11g11b10f;
+			case 28:	return GPUFormat::rgba8;
+			case 29:	return GPUFormat::srgba8;
+			case 30:	return GPUFormat::rgba8u;
+			case 31:	return GPUFormat::rgba8s;
+			case 32:	return GPUFormat::rgba8i;
+			case 34:	return GPUFormat::rg16f;
+			case 35:	return GPUFormat::rg16;
+			case 36:	return GPUFormat::rg16u;
+			case 37:	return GPUFormat::rg16s;
+			case 38:	return GPUFormat::rg16i;
+			case 41:	return GPUFormat::r32f;
+			case 42:	return GPUFormat::r32u;
+			case 43:	return GPUFormat::r32i;
+			case 49:	return GPUFormat::rg8;
+			case 50:	return GPUFormat::rg8u;
+			case 51:	return GPUFormat::rg8s;
+			case 52:	return GPUFormat::rg8i;
+			case 54:	return GPUFormat::r16f;
+			case 56:	return GPUFormat::r16;
+			case 57:	return GPUFormat::r16u;
+			case 58:	return GPUFormat::r16s;
+			case 59:	return GPUFormat::r16i;
+			case 61:	return GPUFormat::r8;
+			case 62:	return GPUFormat::r8u;
+			case 63:	return GPUFormat::r8s;
+			case 64:	return GPUFormat::r8i;
+			case 67:	return GPUFormat::rgb9e5;
+			case 71:	return GPUFormat::bc1;
+			case 72:	return GPUFormat::bc1srgb;
+			case 74:	return GPUFormat::bc2;
+			case 75:	return GPUFormat::bc2srgb;
+			case 77:	return GPUFormat::bc3;
+			case 78:	return GPUFormat::bc3srgb;
+			case 80:	return GPUFormat::bc4;
+			case 81:	return GPUFormat::bc4s;
+			case 83:	return GPUFormat::bc5;
+			case 84:	return GPUFormat::bc5s;
+			case 85:	return GPUFormat::rgb565;
+			case 95:	return GPUFormat::bc6h;
+			case 96:	return GPUFormat::bc6hs;
+			case 98:	return GPUFormat::bc7;
+			case 99:	return GPUFormat::bc7srgb;
+
+			default:	return GPUFormat::NONE;
+		}
+	}
+
+	static GPUFormat vkFormat(u32 format) {
+
+		switch (format) {
+
+			case 4:		return GPUFormat::rgb565;
+			case 9:		return GPUFormat::r8;
+			case 10:	return GPUFormat::r8s;
+			case 13:	return GPUFormat::r8u;
+			case 14:	return GPUFormat::r8i;
+			case 16:	return GPUFormat::rg8;
+			case 17:	return GPUFormat::rg8s;
+			case 20:	return GPUFormat::rg8u;
+			case 21:	return GPUFormat::rg8i;
+			case 37:	return GPUFormat::rgba8;
+			case 38:	return GPUFormat::rgba8s;
+			case 41:	return GPUFormat::rgba8u;
+			case 42:	return GPUFormat::rgba8i;
+			case 43:	return GPUFormat::srgba8;
+			case 64:	return GPUFormat::rgb10a2;
+			case 68:	return GPUFormat::rgb10a2u;
+			case 70:	return GPUFormat::r16;
+			case 71:	return GPUFormat::r16s;
+			case 74:	return GPUFormat::r16u;
+			case 75:	return GPUFormat::r16i;
+			case 76:	return GPUFormat::r16f;
+			case 77:	return GPUFormat::rg16;
+			case 78:	return GPUFormat::rg16s;
+			case 81:	return GPUFormat::rg16u;
+			case 82:	return GPUFormat::rg16i;
+			case 83:	return GPUFormat::rg16f;
+			case 91:	return GPUFormat::rgba16;
+			case 92:	return GPUFormat::rgba16s;
+			case 95:	return GPUFormat::rgba16u;
+			case 96:	return GPUFormat::rgba16i;
+			case 97:	return GPUFormat::rgba16f;
+			case 98:	return GPUFormat::r32u;
+			case 99:	return GPUFormat::r32i;
+			case 100:	return GPUFormat::r32f;
+			case 101:	return GPUFormat::rg32u;
+			case 102:	return GPUFormat::rg32i;
+			case 103:	return GPUFormat::rg32f;
+			case 104:	return GPUFormat::rgb32u;
+			case 105:	return GPUFormat::rgb32i;
+			case 106:	return GPUFormat::rgb32f;
+			case 107:	return GPUFormat::rgba32u;
+			case 108:	return GPUFormat::rgba32i;
+			case 109:	return GPUFormat::rgba32f;
+			case 122:	return GPUFormat::r11g11b10f;
+			case 123:	return GPUFormat::rgb9e5;
+
+			case 131:	case 133:	return GPUFormat::bc1;
+			case 132:	case 134:	return GPUFormat::bc1srgb;
+			case 135:	return GPUFormat::bc2;
+			case 136:	return GPUFormat::bc2srgb;
+			case 137:	return GPUFormat::bc3;
+			case 138:	return GPUFormat::bc3srgb;
+			case 139:	return GPUFormat::bc4;
+			case 140:	return GPUFormat::bc4s;
+			case 141:	return GPUFormat::bc5;
+			case 142:	return GPUFormat::bc5s;
+			case 143:	return GPUFormat::bc6h;
+			case 144:	return GPUFormat::bc6hs;
+			case 145:	return GPUFormat::bc7;
+			case 146:	return GPUFormat::bc7srgb;
+
+			case 147:	return GPUFormat::etc2;
+			case 148:	return GPUFormat::etc2srgb;
+			case 149:	return GPUFormat::etc2a1;
+			case 150:	return GPUFormat::etc2a1srgb;
+			case 151:	return GPUFormat::etc2a8;
+			case 152:	return GPUFormat::etc2a8srgb;
+			case 153:	return GPUFormat::eacr11;
+			case 154:	return GPUFormat::eacr11s;
+			case 155:	return GPUFormat::eacrg11;
+			case 156:	return GPUFormat::eacrg11s;
+
+			case 157:	return GPUFormat::astc4x4;
+			case 158:	return GPUFormat::astc4x4srgb;
+			case 161:	return GPUFormat::astc5x5;
+			case 162:	return GPUFormat::astc5x5srgb;
+			case 165:	return GPUFormat::astc6x6;
+			case 166:	return GPUFormat::astc6x6srgb;
+			case 171:	return GPUFormat::astc8x8;
+			case 172:	return GPUFormat::astc8x8srgb;
+			case 179:	return GPUFormat::astc10x10;
+			case 180:	return GPUFormat::astc10x10srgb;
+			case 183:	return GPUFormat::astc12x12;
+			case 184:	return GPUFormat::astc12x12srgb;
+
+			default:	return GPUFormat::NONE;
+		}
+	}
+
+	static constexpr u32 fourCC(const char (&str)[5]) {
+		return u32(u8(str[0])) | (u32(u8(str[1])) << 8) | (u32(u8(str[2])) << 16) | (u32(u8(str[3])) << 24);
+	}
+
+	//Validate the dimensions against the limits of TextureObject::Info
+
+	static bool isValidLayout(const Vec3u32 &dim, u32 mips, u32 layers, GPUFormat format, TextureType type) {
+
+		if (format == GPUFormat::NONE) {
+			oic::System::log()->error("TextureFile uses an unsupported format");
+			return false;
+		}
+
+		if ((dim > u32(u16_MAX)).any() || !dim.x || !dim.y || !dim.z || !layers || layers > u16_MAX) {
+			oic::System::log()->error("TextureFile has invalid dimensions");
+			return false;
+		}
+
+		u32 biggestRes = std::max(std::max(dim.x, dim.y), dim.z);
+		u32 biggestMip{};
+
+		while (biggestRes >> biggestMip)
+			++biggestMip;
+
+		if (!mips || mips > biggestMip) {
+			oic::System::log()->error("TextureFile has an invalid mip count");
+			return false;
+		}
+
+		auto dimension = type & TextureType::PROPERTY_DIMENSION;
+
+		if (FormatHelper::isCompressed(format) && dimension != TextureType::TEXTURE_2D && dimension != TextureType::TEXTURE_CUBE) {
+			oic::System::log()->error("TextureFile has a compressed format on an unsupported texture type");
+			return false;
+		}
+
+		return true;
+	}
+
+	//Size of one layer of a mip
+
+	static u64 layerBytes(GPUFormat format, const Vec3u32 &dim, u32 mip) {
+		return FormatHelper::getImageBytes(
+			format, std::max(dim.x >> mip, 1u), std::max(dim.y >> mip, 1u), std::max(dim.z >> mip, 1u)
+		);
+	}
+
+	//DDS
+
+	bool TextureFile::loadDDS(const String &path, Texture::Info &info) {
+
+		MappedFile file(path);
+
+		const u8 *ptr = file.get(0, 128);
+
+		if (!ptr || readLE<u32>(ptr) != fourCC("DDS ") || readLE<u32>(ptr + 4) != 124) {
+			oic::System::log()->error("TextureFile isn't a valid DDS file ", path);
+			return false;
+		}
+
+		u32 height = readLE<u32>(ptr + 12), width = readLE<u32>(ptr + 16);
+		u32 depth = readLE<u32>(ptr + 24), mips = std::max(readLE<u32>(ptr + 28), 1u);
+
+		u32 pfFlags = readLE<u32>(ptr + 80), pfFourCC = readLE<u32>(ptr + 84), pfBits = readLE<u32>(ptr + 88);
+		u32 caps2 = readLE<u32>(ptr + 112);
+
+		u64 dataOffset = 128;
+		u32 layers = 1;
+
+		GPUFormat format = GPUFormat::NONE;
+		TextureType type = TextureType::TEXTURE_2D;
+
+		bool isCube = caps2 & 0x200;
+		bool isVolume = caps2 & 0x200000;
+
+		if ((pfFlags & 0x4) && pfFourCC == fourCC("DX10")) {
+
+			const u8 *dx10 = file.get(128, 20);
+
+			if (!dx10) {
+				oic::System::log()->error("TextureFile DDS is missing its DX10 header ", path);
+				return false;
+			}
+
+			dataOffset += 20;
+			format = dxgiFormat(readLE<u32>(dx10));
+
+			u32 dimension = readLE<u32>(dx10 + 4);
+			isCube = readLE<u32>(dx10 + 8) & 0x4;
+			layers = std::max(readLE<u32>(dx10 + 12), 1u);
+
+			isVolume = dimension == 4;
+
+			if (dimension == 2) {
+				type = layers > 1 ? TextureType::TEXTURE_1D_ARRAY : TextureType::TEXTURE_1D;
+				height = 1;
+			}
+
+			else if (dimension != 3 && dimension != 4) {
+				oic::System::log()->error("TextureFile DDS has an invalid resource dimension ", path);
+				return false;
+			}
+		}
+
+		else if (pfFlags & 0x4)
+
+			switch (pfFourCC) {
+				case fourCC("DXT1"):								format = GPUFormat::bc1;		break;
+				case fourCC("DXT2"): case fourCC("DXT3"):			format = GPUFormat::bc2;		break;
+				case fourCC("DXT4"): case fourCC("DXT5"):			format = GPUFormat::bc3;		break;
+				case fourCC("ATI1"): case fourCC("BC4U"):			format = GPUFormat::bc4;		break;
+				case fourCC("BC4S"):								format = GPUFormat::bc4s;		break;
+				case fourCC("ATI2"): case fourCC("BC5U"):			format = GPUFormat::bc5;		break;
+				case fourCC("BC5S"):								format = GPUFormat::bc5s;		break;
+				case 36:											format = GPUFormat::rgba16;		break;
+				case 110:											format = GPUFormat::rgba16s;	break;
+				case 111:											format = GPUFormat::r16f;		break;
+				case 112:											format = GPUFormat::rg16f;		break;
+				case 113:											format = GPUFormat::rgba16f;	break;
+				case 114:											format = GPUFormat::r32f;		break;
+				case 115:											format = GPUFormat::rg32f;		break;
+				case 116:											format = GPUFormat::rgba32f;	break;
+			}
+
+		//Uncompressed legacy formats are only supported if they're in RGBA order
+
+		else if ((pfFlags & 0x40) && pfBits == 32 && readLE<u32>(ptr + 92) == 0xFF && readLE<u32>(ptr + 104) == 0xFF000000)
+			format = GPUFormat::rgba8;
+
+		else if ((pfFlags & 0x20000) && pfBits == 8)
+			format = GPUFormat::r8;
+
+		if (isVolume) {
+			type = TextureType::TEXTURE_3D;
+			depth = std::max(depth, 1u);
+		}
+
+		else {
+
+			depth = 1;
+
+			if (isCube) {
+
+				//Legacy cubemaps have to contain all faces
+
+				if (pfFourCC != fourCC("DX10") && (caps2 & 0xFC00) != 0xFC00) {
+					oic::System::log()->error("TextureFile DDS cubemap is missing faces ", path);
+					return false;
+				}
+
+				type = layers > 1 ? TextureType::TEXTURE_CUBE_ARRAY : TextureType::TEXTURE_CUBE;
+				layers *= 6;
+			}
+
+			else if (type == TextureType::TEXTURE_2D && layers > 1)
+				type = TextureType::TEXTURE_2D_ARRAY;
+		}
+
+		Vec3u32 dim = { width, height, depth };
+
+		if (!isValidLayout(dim, mips, layers, format, type))
+			return false;
+
+		//Every layer stores all of its mips
+
+		Layout layout{ type, dim.cast<Vec3u16>(), format, u8(mips), u16(layers), {}, {} };
+		layout.offsets.resize(usz(mips) * layers);
+
+		u64 offset = dataOffset;
+
+		for (u32 l = 0; l < layers; ++l)
+			for (u32 m = 0; m < mips; ++m) {
+				layout.offsets[usz(m) * layers + l] = offset;
+				offset += layerBytes(format, dim, m);
+			}
+
+		return finish(path, file.size(), layout, info);
+	}
+
+	//KTX2
+
+	bool TextureFile::loadKTX2(const String &path, Texture::Info &info) {
+
+		static constexpr u8 identifier[] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+		MappedFile file(path);
+
+		const u8 *ptr = file.get(0, 80);
+
+		if (!ptr || std::memcmp(ptr, identifier, sizeof(identifier))) {
+			oic::System::log()->error("TextureFile isn't a valid KTX2 file ", path);
+			return false;
+		}
+
+		GPUFormat format = vkFormat(readLE<u32>(ptr + 12));
+
+		Vec3u32 dim = { readLE<u32>(ptr + 20), readLE<u32>(ptr + 24), readLE<u32>(ptr + 28) };
+
+		u32 arrayLayers = readLE<u32>(ptr + 32), faces = readLE<u32>(ptr + 36);
+		u32 mips = std::max(readLE<u32>(ptr + 40), 1u);
+		u32 supercompression = readLE<u32>(ptr + 44);
+
+		//Zstandard (2) and zlib (3) are decoded; BasisLZ (1) needs a transcoder
+
+		if (supercompression != 0 && supercompression != 2 && supercompression != 3) {
+			oic::System::log()->error("TextureFile KTX2 only supports Zstandard and zlib supercompression ", path);
+			return false;
+		}
+
+		if (faces != 1 && faces != 6) {
+			oic::System::log()->error("TextureFile KTX2 has an invalid face count ", path);
+			return false;
+		}
+
+		TextureType type;
+
+		if (!dim.y) {
+			type = arrayLayers ? TextureType::TEXTURE_1D_ARRAY : TextureType::TEXTURE_1D;
+			dim.y = 1;
+		}
+
+		else if (dim.z)
+			type = TextureType::TEXTURE_3D;
+
+		else if (faces == 6)
+			type = arrayLayers ? TextureType::TEXTURE_CUBE_ARRAY : TextureType::TEXTURE_CUBE;
+
+		else type = arrayLayers ? TextureType::TEXTURE_2D_ARRAY : TextureType::TEXTURE_2D;
+
+		dim.z = std::max(dim.z, 1u);
+
+		u32 layers = std::max(arrayLayers, 1u) * faces;
+
+		if (!isValidLayout(dim, mips, layers, format, type))
+			return false;
+
+		const u8 *levels = file.get(80, u64(mips) * 24);
+
+		if (!levels) {
+			oic::System::log()->error("TextureFile KTX2 is missing its level index ", path);
+			return false;
+		}
+
+		//Each level contains every layer, face and slice
+
+		Layout layout{ type, dim.cast<Vec3u16>(), format, u8(mips), u16(layers), {}, {} };
+		layout.offsets.resize(usz(mips) * layers);
+
+		if (supercompression)
+			layout.decoded.resize(mips);
+
+		for (u32 m = 0; m < mips; ++m) {
+
+			u64 levelOffset = readLE<u64>(levels + m * 24_u64);
+			u64 levelSize = readLE<u64>(levels + m * 24_u64 + 8);
+
+			u64 layerSize = layerBytes(format, dim, m);
+
+			//Supercompressed levels are decoded into memory
+
+			if (supercompression) {
+
+				if (readLE<u64>(levels + m * 24_u64 + 16) != layerSize * layers) {
+					oic::System::log()->error("TextureFile KTX2 level has an invalid size ", path);
+					return false;
+				}
+
+				const u8 *compressed = file.get(levelOffset, levelSize);
+				Buffer &level = layout.decoded[m];
+
+				level.resize(usz(layerSize * layers));
+
+				bool decoded{};
+
+				if (compressed && supercompression == 2) {
+					Zstd zstd{ compressed, usz(levelSize), level.data(), level.size() };
+					decoded = zstd.run();
+				}
+
+				else if (compressed) {
+					Inflate inflate{ compressed, usz(levelSize), 0, level.data(), level.size() };
+					decoded = inflate.run();
+				}
+
+				if (!decoded) {
+					oic::System::log()->error("TextureFile KTX2 couldn't be decompressed ", path);
+					return false;
+				}
+
+				levelOffset = 0;
+			}
+
+			else if (levelSize != layerSize * layers) {
+				oic::System::log()->error("TextureFile KTX2 level has an invalid size ", path);
+				return false;
+			}
+
+			for (u32 l = 0; l < layers; ++l)
+				layout.offsets[usz(m) * layers + l] = levelOffset + layerSize * l;
+		}
+
+		return finish(path, file.size(), layout, info);
+	}
+
+	bool TextureFile::load(const String &path, Texture::Info &info) {
+
+		MappedFile file(path);
+		const u8 *ptr = file.get(0, 4);
+
+		if (!ptr) {
+			oic::System::log()->error("TextureFile couldn't be read ", path);
+			return false;
+		}
+
+		if (readLE<u32>(ptr) == fourCC("DDS "))
+			return loadDDS(path, info);
+
+		if (ptr[0] == 0xAB && ptr[1] == 'K' && ptr[2] == 'T' && ptr[3] == 'X')
+			return loadKTX2(path, info);
+
+		oic::System::log()->error("TextureFile has an unknown container ", path);
+		return false;
+	}
+
+	//Create the info; either referencing the file or the decoded data
+
+	bool TextureFile::finish(const String &path, u64 fileSize, const Layout &layout, Texture::Info &info) {
+
+		Texture::Info result(
+			layout.type, layout.dimensions, layout.format, info.usage,
+			layout.mips, layout.layers, 1, true
+		);
+
+		if (layout.decoded.size()) {
+
+			if (!result.init(layout.decoded))
+				return false;
+
+			info = std::move(result);
+			return true;
+		}
+
+		List<FileRegion> regions(layout.offsets.size());
+
+		for (u8 m = 0; m < layout.mips; ++m) {
+
+			u64 size = layerBytes(layout.format, layout.dimensions.cast<Vec3u32>(), m);
+
+			for (u16 l = 0; l < layout.layers; ++l) {
+
+				u64 offset = layout.offsets[usz(m) * layout.layers + l];
+
+				if (offset + size > fileSize) {
+					oic::System::log()->error("TextureFile is truncated ", path);
+					return false;
+				}
+
+				regions[usz(m) * layout.layers + l] = { path, offset, size };
+			}
+		}
+
+		if (!result.init(regions))
+			return false;
+
+		info = std::move(result);
+		return true;
+	}
+
+}
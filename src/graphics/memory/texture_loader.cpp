@@ -0,0 +1,176 @@
+#include "graphics/memory/texture_loader.hpp"
+#include "graphics/memory/texture_file.hpp"
+#include "graphics/memory/mapped_file.hpp"
+#include "graphics/parallel.hpp"
+#include "system/log.hpp"
+#include "system/system.hpp"
+#include <cstring>
+
+namespace ignis {
+
+	TextureLoader::TextureLoader(usz threadCount) {
+
+		if (!threadCount)
+			threadCount = std::max(usz(std::thread::hardware_concurrency()), 1_usz);
+
+		threads.reserve(threadCount);
+
+		for (usz i = 0; i < threadCount; ++i)
+			threads.push_back(std::thread(&TextureLoader::work, this));
+	}
+
+	TextureLoader::~TextureLoader() {
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+
+		jobAdded.notify_all();
+
+		for (auto &thread : threads)
+			thread.join();
+	}
+
+	u64 TextureLoader::add(const Job &job) {
+
+		u64 id{};
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			id = counter++;
+			jobs.push_back({ id, job });
+		}
+
+		jobAdded.notify_one();
+		return id;
+	}
+
+	void TextureLoader::wait() {
+		std::unique_lock<std::mutex> lock(mutex);
+		jobDone.wait(lock, [this]() { return jobStart == jobs.size() && !running; });
+	}
+
+	List<TextureLoader::Loaded> TextureLoader::finish(Graphics &g, usz maxTextures) {
+
+		List<Result> done;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			usz count = std::min(maxTextures, results.size());
+
+			done.reserve(count);
+
+			for (usz i = 0; i < count; ++i)
+				done.push_back(std::move(results[i]));
+
+			results.erase(results.begin(), results.begin() + count);
+		}
+
+		//Only creating the texture is left; the data is copied into the upload buffer by cmd::FlushImage
+
+		List<Loaded> loaded;
+		loaded.reserve(done.size());
+
+		for (auto &result : done)
+			loaded.push_back({
+				result.id, result.name,
+				result.success ? TextureRef(g, result.name, result.info) : TextureRef{}
+			});
+
+		return loaded;
+	}
+
+	void TextureLoader::work() {
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (true) {
+
+			jobAdded.wait(lock, [this]() { return stop || jobStart < jobs.size(); });
+
+			if (stop)
+				return;
+
+			auto [id, job] = std::move(jobs[jobStart++]);
+
+			if (jobStart == jobs.size()) {
+				jobs.clear();
+				jobStart = 0;
+			}
+
+			//Split the job over threads (compression and mip generation) only if some workers are idle;
+			//workers that are running a job (including this one) or will pick up a queued job keep their cores busy
+
+			++running;
+			isPoolThread = running + (jobs.size() - jobStart) >= threads.size();
+
+			lock.unlock();
+
+			Texture::Info info(TextureType::TEXTURE_2D, GPUFormat::rgba8, job.usage);
+			bool success = prepare(job, info);
+
+			if (!success)
+				oic::System::log()->error("TextureLoader couldn't prepare ", job.name);
+
+			lock.lock();
+
+			results.push_back({ id, job.name, std::move(info), success });
+			--running;
+
+			jobDone.notify_all();
+		}
+	}
+
+	bool TextureLoader::prepare(const Job &job, Texture::Info &info) {
+
+		bool loaded = job.decoder ? job.decoder(job.instance, job.path, info) : TextureFile::load(job.path, info);
+
+		if (!loaded)
+			return false;
+
+		info.usage = job.usage;
+		info.isStreaming = job.isStreaming;
+
+		//Decoders can provide only the first mip; files always contain every mip
+
+		info.layout();
+
+		bool generate = job.generateMips && info.mips > 1 && info.files.empty() && !info.hasData();
+
+		//Processing requires the data in memory; the upload would otherwise read from the mapped file
+
+		if (info.files.size() && (job.compression != GPUFormat::NONE || info.needsConversion())) {
+
+			List<MappedFile> mapped;
+			info.initData.resize(info.getDataBytes());
+
+			for (usz i = 0; i < info.files.size(); ++i) {
+
+				const u8 *ptr = MappedFile::get(mapped, info.files[i]);
+
+				if (!ptr)
+					return false;
+
+				std::memcpy(info.initData.data() + info.subresources[i].offset, ptr, info.subresources[i].size);
+			}
+
+			info.files.clear();
+		}
+
+		if (generate && !info.generateMips(job.filter))
+			return false;
+
+		if (job.compression != GPUFormat::NONE && !info.compress(job.compression, job.quality))
+			return false;
+
+		//Convert up front, so the upload is a plain copy
+
+		if (info.needsConversion() && info.files.empty() && !info.convert(info.format))
+			return false;
+
+		return true;
+	}
+
+}
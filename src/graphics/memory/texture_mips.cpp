@@ -0,0 +1,343 @@
+#include "graphics/memory/texture.hpp"
+#include "graphics/format_converter.hpp"
+#include "graphics/parallel.hpp"
+#include "system/log.hpp"
+#include "system/system.hpp"
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX__)
+	#define IGNIS_MIPS_AVX
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define IGNIS_MIPS_SSE
+#endif
+
+#if defined(IGNIS_MIPS_AVX) || defined(IGNIS_MIPS_SSE)
+	#include <immintrin.h>
+#endif
+
+namespace ignis {
+
+	//Filter kernels; x is in destination texels
+
+	static constexpr f64 kaiserAlpha = 4, kaiserRadius = 3;
+
+	static f64 besselI0(f64 x) {
+
+		f64 sum = 1, term = 1;
+
+		for (u32 k = 1; k < 32; ++k) {
+			f64 t = x / (2 * k);
+			term *= t * t;
+			sum += term;
+		}
+
+		return sum;
+	}
+
+	static f64 mipFilterRadius(MipFilter filter) {
+
+		switch (filter) {
+			case MipFilter::BOX:		return .5;
+			case MipFilter::TRIANGLE:	return 1;
+			default:					return kaiserRadius;
+		}
+	}
+
+	static f64 mipFilterWeight(MipFilter filter, f64 x) {
+
+		x = std::abs(x);
+
+		switch (filter) {
+
+			case MipFilter::BOX:
+				return x < .5 ? 1 : (x == .5 ? .5 : 0);
+
+			case MipFilter::TRIANGLE:
+				return std::max(1 - x, 0.0);
+
+			default: {
+
+				if (x >= kaiserRadius)
+					return 0;
+
+				constexpr f64 pi = 3.14159265358979323846;
+
+				f64 sinc = x < 1e-8 ? 1 : std::sin(pi * x) / (pi * x);
+				f64 r = x / kaiserRadius;
+
+				return sinc * besselI0(kaiserAlpha * std::sqrt(1 - r * r)) / besselI0(kaiserAlpha);
+			}
+		}
+	}
+
+	//Normalized filter taps for every destination texel of an axis
+
+	struct MipTaps {
+
+		List<u32> begin;		//[dst + 1] into index and weight
+		List<u32> index;
+		List<f32> weight;
+
+		MipTaps(MipFilter filter, usz src, usz dst): begin(dst + 1) {
+
+			f64 scale = f64(src) / dst;
+			f64 support = std::max(scale, 1.0);
+			f64 radius = mipFilterRadius(filter) * support;
+
+			for (usz d = 0; d < dst; ++d) {
+
+				f64 center = (d + .5) * scale;
+
+				isz lo = isz(std::floor(center - radius));
+				isz hi = isz(std::ceil(center + radius));
+
+				usz start = index.size();
+				f64 sum{};
+
+				for (isz i = lo; i <= hi; ++i) {
+
+					f64 w = mipFilterWeight(filter, (i + .5 - center) / support);
+
+					if (w == 0)
+						continue;
+
+					index.push_back(u32(std::clamp(i, isz(0), isz(src - 1))));
+					weight.push_back(f32(w));
+					sum += w;
+				}
+
+				//Fall back to the nearest texel if the kernel didn't cover anything
+
+				if (sum == 0) {
+					index.resize(start);
+					weight.resize(start);
+					index.push_back(u32(std::min(usz(center), src - 1)));
+					weight.push_back(1);
+				}
+
+				else for (usz i = start; i < weight.size(); ++i)
+					weight[i] = f32(weight[i] / sum);
+
+				begin[d] = u32(start);
+			}
+
+			begin[dst] = u32(index.size());
+		}
+	};
+
+	//dst[i] += src[i] * w
+
+	static inline void mipAxpy(f32 *dst, const f32 *src, f32 w, usz n) {
+
+		usz i{};
+
+		#ifdef IGNIS_MIPS_AVX
+
+			__m256 w8 = _mm256_set1_ps(w);
+
+			for (; i + 8 <= n; i += 8)
+				_mm256_storeu_ps(
+					dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), w8))
+				);
+
+		#endif
+
+		#ifdef IGNIS_MIPS_SSE
+
+			__m128 w4 = _mm_set1_ps(w);
+
+			for (; i + 4 <= n; i += 4)
+				_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), w4)));
+
+		#endif
+
+		for (; i < n; ++i)
+			dst[i] += src[i] * w;
+	}
+
+	//Resample along an axis that isn't the inner most one (y or z)
+	//Every line of rowLength floats is a weighted sum of the source lines, which vectorizes well
+
+	static void mipResampleRows(
+		const f32 *src, f32 *dst, const MipTaps &taps,
+		usz outer, usz srcCount, usz dstCount, usz inner, usz rowLength
+	) {
+
+		//Small mips are resampled on the calling thread
+
+		const usz work = taps.index.size() * rowLength / std::max(dstCount, usz(1));
+
+		parallelFor(outer * dstCount * inner, parallelMinItems(work), [&](usz line) {
+
+			usz i = line % inner;
+			usz d = (line / inner) % dstCount;
+			usz o = line / inner / dstCount;
+
+			f32 *out = dst + line * rowLength;
+
+			for (u32 t = taps.begin[d]; t < taps.begin[d + 1]; ++t)
+				mipAxpy(out, src + ((o * srcCount + taps.index[t]) * inner + i) * rowLength, taps.weight[t], rowLength);
+		});
+	}
+
+	//Resample along x; every line is a row of texels with the channels interleaved
+
+	static void mipResampleColumns(
+		const f32 *src, f32 *dst, const MipTaps &taps,
+		usz lines, usz srcCount, usz dstCount, usz channels
+	) {
+
+		parallelFor(lines, parallelMinItems(taps.index.size() * channels), [&](usz line) {
+
+			const f32 *in = src + line * srcCount * channels;
+			f32 *out = dst + line * dstCount * channels;
+
+			for (usz d = 0; d < dstCount; ++d) {
+
+				#ifdef IGNIS_MIPS_SSE
+
+					if (channels == 4) {
+
+						__m128 acc = _mm_setzero_ps();
+
+						for (u32 t = taps.begin[d]; t < taps.begin[d + 1]; ++t)
+							acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(in + taps.index[t] * 4_usz), _mm_set1_ps(taps.weight[t])));
+
+						_mm_storeu_ps(out + d * 4, acc);
+						continue;
+					}
+
+				#endif
+
+				for (usz c = 0; c < channels; ++c) {
+
+					f32 acc{};
+
+					for (u32 t = taps.begin[d]; t < taps.begin[d + 1]; ++t)
+						acc += in[taps.index[t] * channels + c] * taps.weight[t];
+
+					out[d * channels + c] = acc;
+				}
+			}
+		});
+	}
+
+	//Downsample a layer with dimensions s to d
+
+	static List<f32> mipResample(List<f32> src, Vec3usz s, const Vec3usz &d, usz channels, MipFilter filter) {
+
+		List<f32> dst;
+
+		if (d.z != s.z) {
+			dst.assign(s.x * s.y * d.z * channels, 0);
+			mipResampleRows(src.data(), dst.data(), MipTaps(filter, s.z, d.z), 1, s.z, d.z, s.y, s.x * channels);
+			src.swap(dst);
+			s.z = d.z;
+		}
+
+		if (d.y != s.y) {
+			dst.assign(s.x * d.y * s.z * channels, 0);
+			mipResampleRows(src.data(), dst.data(), MipTaps(filter, s.y, d.y), s.z, s.y, d.y, 1, s.x * channels);
+			src.swap(dst);
+			s.y = d.y;
+		}
+
+		if (d.x != s.x) {
+			dst.resize(d.x * s.y * s.z * channels);
+			mipResampleColumns(src.data(), dst.data(), MipTaps(filter, s.x, d.x), s.y * s.z, s.x, d.x, channels);
+			src.swap(dst);
+		}
+
+		return src;
+	}
+
+	static bool isMipFormatSupported(GPUFormat format) {
+
+		if (
+			FormatHelper::isNone(format) || format == GPUFormat::NONE || 
+			FormatHelper::isInt(format) || FormatHelper::isCompressed(format) || FormatHelper::isPacked(format)
+		)
+			return false;
+
+		switch (FormatHelper::getType(format)) {
+
+			case GPUFormatType::UNORM:
+			case GPUFormatType::SNORM:
+				return FormatHelper::getStrideBytes(format) <= 2;
+
+			case GPUFormatType::FLOAT:
+				return FormatHelper::getStrideBytes(format) >= 2;
+
+			default:
+				return false;
+		}
+	}
+
+	//Generate the mip chain
+
+	bool Texture::Info::generateMips(MipFilter filter) {
+
+		//Mips are generated in the format of the data; it's converted when it's uploaded
+
+		GPUFormat source = getDataFormat();
+
+		usz channels = FormatHelper::getChannelCount(source);
+
+		layout();
+
+		if (initData.size() < getMipBytes(0) || initData.empty()) {
+			oic::System::log()->error("Texture::Info::generateMips requires the first mip");
+			return false;
+		}
+
+		if (!isMipFormatSupported(source)) {
+			oic::System::log()->error("Texture::Info::generateMips doesn't support integer or compressed formats");
+			return false;
+		}
+
+		if (samples > 1) {
+			oic::System::log()->error("Texture::Info::generateMips doesn't support multisampled textures");
+			return false;
+		}
+
+		//Layers are filtered separately; so the layer isn't part of the dimensions
+
+		usz layerId = (textureType & ~TextureType::PROPERTY_IS_ARRAY) == TextureType::TEXTURE_1D ? 1 : 2;
+
+		auto layerDimensions = [this, layerId](u8 m) {
+
+			Vec3usz dim = mipSizes[m].cast<Vec3usz>();
+
+			if (layers > 1)
+				dim.arr[layerId] = 1;
+
+			return dim;
+		};
+
+		initData.resize(getDataBytes());
+
+		for (u16 l = 0; l < layers; ++l) {
+
+			Vec3usz dim = layerDimensions(0);
+			List<f32> cur(dim.prod<usz>() * channels);
+
+			FormatConverter::decode(source, initData.data() + getSubresource(0, l).offset, cur.data(), dim.prod<usz>());
+
+			for (u8 m = 1; m < mips; ++m) {
+
+				Vec3usz next = layerDimensions(m);
+
+				cur = mipResample(std::move(cur), dim, next, channels, filter);
+				dim = next;
+
+				FormatConverter::encode(source, cur.data(), initData.data() + getSubresource(m, l).offset, dim.prod<usz>());
+			}
+		}
+
+		return true;
+	}
+
+}
@@ -59,6 +59,17 @@ namespace ignis {
 		if(std::log2(samples) != std::floor(std::log2(samples)))
 			oic::System::log()->fatal("Texture created with invalid samples!");
 
+		if (FormatHelper::isCompressed(format)) {
+
+			auto dim = textureType & TextureType::PROPERTY_DIMENSION;
+
+			if ((dim != TextureType::TEXTURE_2D && dim != TextureType::TEXTURE_CUBE) || HasFlags(textureType, TextureType::PROPERTY_IS_MS))
+				oic::System::log()->fatal("Compressed formats are only supported on 2D and cube textures");
+
+			if (HasFlags(usage, GPUMemoryUsage::GPU_WRITE))
+				oic::System::log()->fatal("Compressed textures can't be GPU writable");
+		}
+
 		//Automatically determine mips
 
 		u32 biggestRes =
@@ -70,7 +81,7 @@ namespace ignis {
 				dimensions.z
 			);
 
-		u8 biggestMip = u8(oic::Math::ceil(oic::Math::log2<f64>(biggestRes)) + 1);
+		u8 biggestMip = u8(oic::Math::floor(oic::Math::log2<f64>(biggestRes)) + 1);
 
 		if (!mips || mips > biggestMip)
 			oic::System::log()->fatal("Texture created with too many or no mips!");
@@ -89,7 +100,7 @@ namespace ignis {
 
 		for (u8 i = 0; i < mips; ++i) {
 			mipSizes[i] = dims;
-			dims = (dims.cast<Vec3f32>() / div).ceil().cast<Vec3u16>();
+			dims = (dims.cast<Vec3f32>() / div).floor().cast<Vec3u16>().max(Vec3u16(1, 1, 1));
 		}
 	}
 
@@ -124,21 +135,54 @@ namespace ignis {
 		return maxDim;
 	}
 
-	usz TextureObject::size(u8 mip, u16, u16, bool isStencil) const {
+	usz TextureObject::size(u8 mip, bool isStencil) const {
 
-		usz stride;
+		//One layer; layers are stored in y (1D) or z of the mip size
 
-		if (const DepthTexture *dt = dynamic_cast<const DepthTexture*>(this))
-			stride = isStencil ? FormatHelper::getStencilBytes(dt->getFormat()) : FormatHelper::getDepthBytes(dt->getFormat());
-		else
-			stride = FormatHelper::getSizeBytes(info.format);
+		Vec3usz dim = info.mipSizes[mip].cast<Vec3usz>();
 
-		return info.mipSizes[mip].xy().prod<usz>() * stride;
-	}
+		if ((info.textureType & ~TextureType::PROPERTY_IS_ARRAY) == TextureType::TEXTURE_1D)
+			dim.y = 1;
+
+		else if (info.textureType != TextureType::TEXTURE_3D)
+			dim.z = 1;
+
+		if (getTextureObjectType() == TextureObjectType::DEPTH) {
 
+			DepthFormat format = static_cast<const DepthTexture*>(this)->getFormat();
+
+			return dim.prod<usz>() * (
+				isStencil ? FormatHelper::getStencilBytes(format) : FormatHelper::getDepthBytes(format)
+			);
+		}
+
+		return FormatHelper::getImageBytes(info.format, dim.x, dim.y, dim.z);
+	}
 
 	bool TextureObject::isValidRange(const TextureRange &range) const {
-		return range.mip < info.mips && ((range.start + range.size) <= getDimensions(range.mip)).all();
+
+		if (range.mip >= info.mips)
+			return false;
+
+		auto dim = getDimensions(range.mip);
+		auto end = range.start + range.size;
+
+		if (!(end <= dim).all())
+			return false;
+
+		//Compressed ranges have to start on a block and end on a block or the edge of the mip
+
+		if (FormatHelper::isCompressed(info.format)) {
+
+			const usz bw = FormatHelper::getBlockWidth(info.format), bh = FormatHelper::getBlockHeight(info.format);
+
+			return
+				!(range.start.x % bw) && !(range.start.y % bh) &&
+				(!(end.x % bw) || end.x == dim.x) &&
+				(!(end.y % bh) || end.y == dim.y);
+		}
+
+		return true;
 	}
 
 	bool TextureObject::isValidSubresource(const GPUSubresource &res, bool isSampler) const {
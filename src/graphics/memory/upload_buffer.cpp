@@ -1,4 +1,6 @@
 #include "graphics/memory/upload_buffer.hpp"
+#include "graphics/parallel.hpp"
+#include "graphics/format_converter.hpp"
 
 namespace ignis {
 
@@ -18,7 +20,8 @@ namespace ignis {
 			0,
 			inf.startSize | Allocation::freeBit,
 			0,
-			0
+			0,
+			false
 		});
 	}
 
@@ -38,6 +41,147 @@ namespace ignis {
 
 		mutex.lock();
 
+		auto allocation = allocateInternal(executionId, size, alignment, true);
+
+		//Copy memory on cpu and shared memory
+
+		if (allocation.second != u64_MAX) {
+
+			u8 *ptr = info.buffers[allocation.first]->getBuffer() + allocation.second;
+
+			if (data)
+				std::memcpy(ptr, data, size);
+			else
+				std::memset(ptr, 0, size);
+		}
+
+		//Return allocation and finish mutex
+
+		mutex.unlock();
+		return allocation;
+	}
+
+	Pair<u64, u64> UploadBuffer::reserve(u64 executionId, const usz size, u32 alignment) {
+		mutex.lock();
+		auto allocation = allocateInternal(executionId, size, alignment, false);
+		mutex.unlock();
+		return allocation;
+	}
+
+	Pair<u64, u64> UploadBuffer::allocate(u64 executionId, const u8 *data, const List<Vec2u64> &ranges, u32 alignment) {
+
+		List<Pair<const u8*, u64>> spans(ranges.size());
+
+		for (usz i = 0; i < ranges.size(); ++i)
+			spans[i] = { data + ranges[i].x, ranges[i].y };
+
+		return allocate(executionId, spans, alignment);
+	}
+
+	Pair<u64, u64> UploadBuffer::allocate(u64 executionId, const List<Pair<const u8*, u64>> &spans, u32 alignment) {
+
+		u64 size{};
+
+		for (auto &span : spans)
+			size += span.second;
+
+		mutex.lock();
+
+		auto allocation = allocateInternal(executionId, size, alignment, true);
+
+		if (allocation.second == u64_MAX) {
+			mutex.unlock();
+			return allocation;
+		}
+
+		u8 *ptr = info.buffers[allocation.first]->getBuffer() + allocation.second;
+
+		mutex.unlock();
+
+		//Small gathers are faster on the current thread
+
+		static constexpr u64 chunkSize = 256_u64 << 10;
+
+		if (size < (chunkSize << 2)) {
+
+			for (auto &span : spans) {
+				std::memcpy(ptr, span.first, span.second);
+				ptr += span.second;
+			}
+
+			return allocation;
+		}
+
+		//Split the spans into chunks so every thread copies about the same amount
+
+		struct Chunk {
+			u8 *dst;
+			const u8 *src;
+			u64 size;
+		};
+
+		List<Chunk> chunks;
+		chunks.reserve(usz(size / chunkSize + spans.size()));
+
+		for (auto &span : spans) {
+
+			for (u64 i = 0; i < span.second; i += chunkSize)
+				chunks.push_back({ ptr + i, span.first + i, std::min(chunkSize, span.second - i) });
+
+			ptr += span.second;
+		}
+
+		parallelFor(chunks.size(), 2, [&chunks](usz i) {
+			std::memcpy(chunks[i].dst, chunks[i].src, chunks[i].size);
+		});
+
+		return allocation;
+	}
+
+	Pair<u64, u64> UploadBuffer::allocate(
+		u64 executionId, const List<Pair<const u8*, u64>> &spans, u32 alignment,
+		GPUFormat src, GPUFormat dst, bool swapRB
+	) {
+
+		if (src == dst && !swapRB)
+			return allocate(executionId, spans, alignment);
+
+		if (!FormatConverter::canConvert(src, dst)) {
+			oic::System::log()->error("UploadBuffer can't convert between the formats");
+			return { 0, u64_MAX };
+		}
+
+		const usz srcSize = FormatHelper::getSizeBytes(src);
+		u64 size{};
+
+		for (auto &span : spans)
+			size += FormatConverter::getConvertedBytes(src, dst, usz(span.second));
+
+		mutex.lock();
+
+		auto allocation = allocateInternal(executionId, size, alignment, true);
+
+		if (allocation.second == u64_MAX) {
+			mutex.unlock();
+			return allocation;
+		}
+
+		u8 *ptr = info.buffers[allocation.first]->getBuffer() + allocation.second;
+
+		mutex.unlock();
+
+		//Convert straight into the shared memory; the conversion is threaded
+
+		for (auto &span : spans) {
+			FormatConverter::convert(src, span.first, dst, ptr, usz(span.second) / srcSize, swapRB);
+			ptr += FormatConverter::getConvertedBytes(src, dst, usz(span.second));
+		}
+
+		return allocation;
+	}
+
+	Pair<u64, u64> UploadBuffer::allocateInternal(u64 executionId, const usz size, u32 alignment, bool isDirty) {
+
 		//Find allocation
 
 		auto &a = info.allocations;
@@ -65,6 +209,7 @@ namespace ignis {
 			if (siz == req) {
 				ai.sizeAndFree = siz;
 				ai.executionId = executionId;
+				ai.isDirty = isDirty;
 			}
 
 			//Generate two seperate allocations
@@ -75,27 +220,17 @@ namespace ignis {
 
 				ai.sizeAndFree = req;
 				ai.executionId = executionId;
+				ai.isDirty = isDirty;
 
 				a.insert(a.begin() + i + 1, Allocation{
 					ai.offset + req,
 					leftOver | Allocation::freeBit,
 					u64_MAX,
-					bufferId
+					bufferId,
+					false
 				});
 			}
 
-			//Copy memory on cpu and shared memory
-
-			auto *buf = info.buffers[bufferId];
-
-			if (data)
-				std::memcpy(buf->getBuffer() + align, data, size);
-			else
-				std::memset(buf->getBuffer() + align, 0, size);
-
-			//Return allocation and finish mutex
-
-			mutex.unlock();
 			return { bufferId, align };
 		}
 
@@ -110,7 +245,6 @@ namespace ignis {
 
 		if (biggest == info.maxSize) {
 			oic::System::log()->error("UploadBuffer out of memory exception");
-			mutex.unlock();
 			return { 0, u64_MAX };
 		}
 
@@ -123,7 +257,6 @@ namespace ignis {
 
 		if(size > newSize) {
 			oic::System::log()->error("UploadBuffer out of memory exception");
-			mutex.unlock();
 			return { 0, u64_MAX };
 		}
 
@@ -131,7 +264,7 @@ namespace ignis {
 
 		u64 bufferId = ++info.bufferCounter;
 
-		auto *buf = info.buffers[bufferId] = new GPUBuffer(
+		info.buffers[bufferId] = new GPUBuffer(
 			getGraphics(), NAME(getName() + " buffer " + std::to_string(bufferId)),
 			GPUBuffer::Info(
 				newSize, GPUBufferUsage::STAGING, 
@@ -141,16 +274,12 @@ namespace ignis {
 
 		//Create main allocation
 
-		if (data)
-			std::memcpy(buf->getBuffer(), data, size);
-		else
-			std::memset(buf->getBuffer(), 0, size);
-
 		info.allocations.push_back(Allocation{
 			0,
 			size,
 			executionId,
-			bufferId
+			bufferId,
+			isDirty
 		});
 
 		//Create left over block
@@ -160,12 +289,12 @@ namespace ignis {
 				size,
 				(newSize - size) | Allocation::freeBit,
 				u64_MAX,
-				bufferId
+				bufferId,
+				false
 			});
 
 		//Return to program
 
-		mutex.unlock();
 		return { bufferId, 0 };
 	}
 
@@ -177,42 +306,43 @@ namespace ignis {
 
 		u64 prev = u64_MAX, bufferId = u64_MAX, biggest{};
 
-		for(auto &alloc : info.allocations)
-			if (alloc.executionId == executionId) {
+		//Mark the written range as pending, so the staging buffer pushes it to the GPU
+		//Only allocations written since the last flush are pushed; every execute of the execution flushes again
 
-				if (prev == u64_MAX) {
-					prev = alloc.offset;
-					biggest = prev + alloc.getSize();
-					bufferId = alloc.bufferId;
-				}
-				else if (bufferId != alloc.bufferId) {
+		auto flushRange = [this, cdata](u64 id, u64 start, u64 end) {
+
+			auto it = info.buffers.find(id);
+
+			if (it != info.buffers.end()) {
+				it->second->flush(start, end - start);
+				it->second->flush(cdata, nullptr, { start, end });
+			}
+		};
 
-					auto it = info.buffers.find(bufferId);
+		for(auto &alloc : info.allocations)
+			if (alloc.executionId == executionId && alloc.isDirty) {
 
-					if (it != info.buffers.end())
-						it->second->flush(cdata, nullptr, { prev, biggest });
+				alloc.isDirty = false;
 
+				if (prev != u64_MAX && bufferId != alloc.bufferId) {
+					flushRange(bufferId, prev, biggest);
 					prev = u64_MAX;
 				}
-				else biggest = alloc.offset + alloc.getSize();
-
-			} else if(prev != u64_MAX) {
 
-				auto it = info.buffers.find(bufferId);
+				if (prev == u64_MAX) {
+					prev = alloc.offset;
+					bufferId = alloc.bufferId;
+				}
 
-				if (it != info.buffers.end())
-					it->second->flush(cdata, nullptr, { prev, biggest });
+				biggest = alloc.offset + alloc.getSize();
 
+			} else if(prev != u64_MAX) {
+				flushRange(bufferId, prev, biggest);
 				prev = u64_MAX;
 			}
 
-		if (prev != u64_MAX) {
-
-			auto it = info.buffers.find(bufferId);
-
-			if (it != info.buffers.end())
-				it->second->flush(cdata, nullptr, { prev, biggest });
-		}
+		if (prev != u64_MAX)
+			flushRange(bufferId, prev, biggest);
 
 		mutex.unlock();
 	}
@@ -281,7 +411,8 @@ namespace ignis {
 					offset,
 					size | Allocation::freeBit,
 					u64_MAX,
-					bufferId
+					bufferId,
+					false
 				});
 
 				++i;
@@ -318,7 +449,8 @@ namespace ignis {
 				offset,
 				size | Allocation::freeBit,
 				u64_MAX,
-				bufferId
+				bufferId,
+				false
 			});
 
 		}
@@ -359,7 +491,8 @@ namespace ignis {
 					0,
 					newSize | Allocation::freeBit,
 					u64_MAX,
-					bufferId
+					bufferId,
+					false
 				});
 			}
 
@@ -378,4 +511,23 @@ namespace ignis {
 		return it->second->readback(allocation.second, size);
 	}
 
+	Buffer UploadBuffer::readback(const Pair<u64, u64> &allocation, u64 size, GPUFormat src, GPUFormat dst, bool swapRB) {
+
+		if (src == dst && !swapRB)
+			return readback(allocation, size);
+
+		Buffer result(FormatConverter::getConvertedBytes(src, dst, usz(size)));
+
+		if (!FormatConverter::convert(src, readbackView(allocation, size), dst, result.data(), usz(size) / FormatHelper::getSizeBytes(src), swapRB))
+			return {};
+
+		return result;
+	}
+
+	const u8 *UploadBuffer::readbackView(const Pair<u64, u64> &allocation, u64 size) {
+		auto it = info.buffers.find(allocation.first);
+		oicAssert("Buffer out of bounds", it != info.buffers.end());
+		return it->second->readbackView(allocation.second, size);
+	}
+
 }
\ No newline at end of file
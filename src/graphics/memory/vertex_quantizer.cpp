@@ -0,0 +1,378 @@
+#include "graphics/memory/vertex_quantizer.hpp"
+#include "graphics/format_converter.hpp"
+#include "graphics/parallel.hpp"
+#include "system/log.hpp"
+#include "system/system.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define IGNIS_QUANTIZE_SSE
+	#include <immintrin.h>
+#endif
+
+namespace ignis {
+
+	//Vertices per job and per block; a block is quantized from and into scratch on the stack
+
+	static constexpr usz quantizeChunk = 1 << 14, quantizeBlock = 256;
+
+	struct QuantizeJob {
+
+		u32 src, dst;				//Offset in the vertex
+		u32 srcSize;
+		u8 channels;				//Of the source
+
+		VertexQuantization mode;
+		GPUFormat format;
+
+		f32 offset[4], mul[4];		//UNORM16: (v - offset) * mul
+	};
+
+	GPUFormat VertexQuantizer::getFormat(GPUFormat format, VertexQuantization mode) {
+
+		if (mode == VertexQuantization::NONE)
+			return format;
+
+		if (
+			FormatHelper::isCompressed(format) || FormatHelper::isPacked(format) ||
+			!FormatHelper::isFloatingPoint(format) || FormatHelper::getStrideBytes(format) != 4
+		)
+			return GPUFormat::NONE;
+
+		const usz channels = FormatHelper::getChannelCount(format);
+
+		switch (mode) {
+
+			case VertexQuantization::HALF:
+				return channels <= 2 ? GPUFormat::rg16f : GPUFormat::rgba16f;
+
+			case VertexQuantization::UNORM16:
+				return channels <= 2 ? GPUFormat::rg16 : GPUFormat::rgba16;
+
+			default:
+
+				if (channels == 3)
+					return GPUFormat::rg16s;
+
+				return channels == 4 ? GPUFormat::rgb10a2s : GPUFormat::NONE;
+		}
+	}
+
+	//Encoders (per channel arrays to i32)
+
+	static void encodeUnorm16(const f32 *in, i32 *out, usz n, f32 offset, f32 mul) {
+
+		usz i{};
+
+		#ifdef IGNIS_QUANTIZE_SSE
+
+			const __m128 o = _mm_set1_ps(offset), m = _mm_set1_ps(mul);
+			const __m128 zero = _mm_setzero_ps(), max = _mm_set1_ps(65535);
+
+			for (; i + 4 <= n; i += 4) {
+				__m128 v = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(in + i), o), m);
+				_mm_storeu_si128((__m128i*)(out + i), _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(v, zero), max)));
+			}
+
+		#endif
+
+		for (; i < n; ++i)
+			out[i] = i32(std::nearbyint(std::clamp((in[i] - offset) * mul, 0.f, 65535.f)));
+	}
+
+	//Project on the octahedron and fold the lower hemisphere over the diagonals
+
+	static void encodeOctahedral(const f32 *x, const f32 *y, const f32 *z, i32 *ox, i32 *oy, usz n) {
+
+		usz i{};
+
+		#ifdef IGNIS_QUANTIZE_SSE
+
+			const __m128 signMask = _mm_set1_ps(-0.f), one = _mm_set1_ps(1), zero = _mm_setzero_ps();
+			const __m128 eps = _mm_set1_ps(1e-20f), scale = _mm_set1_ps(32767);
+
+			for (; i + 4 <= n; i += 4) {
+
+				__m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+
+				__m128 sum = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signMask, vx), _mm_andnot_ps(signMask, vy)), _mm_andnot_ps(signMask, vz));
+				__m128 inv = _mm_div_ps(one, _mm_max_ps(sum, eps));
+
+				vx = _mm_mul_ps(vx, inv);
+				vy = _mm_mul_ps(vy, inv);
+
+				__m128 fx = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, vy)), _mm_or_ps(one, _mm_and_ps(vx, signMask)));
+				__m128 fy = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, vx)), _mm_or_ps(one, _mm_and_ps(vy, signMask)));
+
+				__m128 lower = _mm_cmplt_ps(vz, zero);
+
+				vx = _mm_or_ps(_mm_and_ps(lower, fx), _mm_andnot_ps(lower, vx));
+				vy = _mm_or_ps(_mm_and_ps(lower, fy), _mm_andnot_ps(lower, vy));
+
+				_mm_storeu_si128((__m128i*)(ox + i), _mm_cvtps_epi32(_mm_mul_ps(vx, scale)));
+				_mm_storeu_si128((__m128i*)(oy + i), _mm_cvtps_epi32(_mm_mul_ps(vy, scale)));
+			}
+
+		#endif
+
+		for (; i < n; ++i) {
+
+			f32 inv = 1 / std::max(std::abs(x[i]) + std::abs(y[i]) + std::abs(z[i]), 1e-20f);
+			f32 u = x[i] * inv, v = y[i] * inv;
+
+			if (z[i] < 0) {
+				f32 fu = (1 - std::abs(v)) * std::copysign(1.f, u);
+				v = (1 - std::abs(u)) * std::copysign(1.f, v);
+				u = fu;
+			}
+
+			ox[i] = i32(std::nearbyint(u * 32767));
+			oy[i] = i32(std::nearbyint(v * 32767));
+		}
+	}
+
+	//Normalized xyz as snorm10 and the sign of w as a 2 bit int (rgb10a2s)
+
+	static void encodeTangent(const f32 *x, const f32 *y, const f32 *z, const f32 *w, i32 *out, usz n) {
+
+		usz i{};
+
+		#ifdef IGNIS_QUANTIZE_SSE
+
+			const __m128 signMask = _mm_set1_ps(-0.f), one = _mm_set1_ps(1);
+			const __m128 eps = _mm_set1_ps(1e-20f), scale = _mm_set1_ps(511);
+			const __m128i mask = _mm_set1_epi32(0x3FF);
+
+			for (; i + 4 <= n; i += 4) {
+
+				__m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+
+				__m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+				__m128 inv = _mm_div_ps(scale, _mm_sqrt_ps(_mm_max_ps(len2, eps)));
+
+				__m128i ix = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(vx, inv)), mask);
+				__m128i iy = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(vy, inv)), mask);
+				__m128i iz = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(vz, inv)), mask);
+				__m128i iw = _mm_cvtps_epi32(_mm_or_ps(one, _mm_and_ps(_mm_loadu_ps(w + i), signMask)));
+
+				__m128i packed = _mm_or_si128(
+					_mm_or_si128(ix, _mm_slli_epi32(iy, 10)),
+					_mm_or_si128(_mm_slli_epi32(iz, 20), _mm_slli_epi32(iw, 30))
+				);
+
+				_mm_storeu_si128((__m128i*)(out + i), packed);
+			}
+
+		#endif
+
+		for (; i < n; ++i) {
+
+			f32 inv = 511 / std::sqrt(std::max(x[i] * x[i] + y[i] * y[i] + z[i] * z[i], 1e-20f));
+
+			u32 ix = u32(i32(std::nearbyint(x[i] * inv))) & 0x3FF;
+			u32 iy = u32(i32(std::nearbyint(y[i] * inv))) & 0x3FF;
+			u32 iz = u32(i32(std::nearbyint(z[i] * inv))) & 0x3FF;
+			u32 iw = std::signbit(w[i]) ? 3 : 1;
+
+			out[i] = i32(ix | (iy << 10) | (iz << 20) | (iw << 30));
+		}
+	}
+
+	//Quantize n vertices of an attribute
+
+	static void quantizeRange(const QuantizeJob &job, const u8 *src, usz srcStride, u8 *dst, usz dstStride, usz n) {
+
+		if (job.mode == VertexQuantization::NONE) {
+
+			for (usz i = 0; i < n; ++i)
+				std::memcpy(dst + i * dstStride + job.dst, src + i * srcStride + job.src, job.srcSize);
+
+			return;
+		}
+
+		f32 in[4][quantizeBlock];
+		i32 out[4][quantizeBlock];
+
+		for (usz i = 0; i < n; ++i)
+			for (usz c = 0; c < job.channels; ++c)
+				std::memcpy(&in[c][i], src + i * srcStride + job.src + c * 4, 4);
+
+		const usz dstChannels = FormatHelper::getChannelCount(job.format);
+
+		switch (job.mode) {
+
+			case VertexQuantization::HALF: {
+
+				u16 half[4][quantizeBlock];
+
+				for (usz c = 0; c < job.channels; ++c)
+					FormatConverter::floatToHalf(in[c], half[c], n);
+
+				for (usz i = 0; i < n; ++i)
+					for (usz c = 0; c < dstChannels; ++c) {
+						u16 v = c < job.channels ? half[c][i] : u16(c == 3 ? 0x3C00 : 0);
+						std::memcpy(dst + i * dstStride + job.dst + c * 2, &v, 2);
+					}
+
+				break;
+			}
+
+			case VertexQuantization::UNORM16:
+
+				for (usz c = 0; c < job.channels; ++c)
+					encodeUnorm16(in[c], out[c], n, job.offset[c], job.mul[c]);
+
+				for (usz i = 0; i < n; ++i)
+					for (usz c = 0; c < dstChannels; ++c) {
+						u16 v = c < job.channels ? u16(out[c][i]) : u16(c == 3 ? 0xFFFF : 0);
+						std::memcpy(dst + i * dstStride + job.dst + c * 2, &v, 2);
+					}
+
+				break;
+
+			default:
+
+				if (job.channels == 3) {
+
+					encodeOctahedral(in[0], in[1], in[2], out[0], out[1], n);
+
+					for (usz i = 0; i < n; ++i) {
+						i16 v[2] = { i16(out[0][i]), i16(out[1][i]) };
+						std::memcpy(dst + i * dstStride + job.dst, v, 4);
+					}
+				}
+
+				else {
+
+					encodeTangent(in[0], in[1], in[2], in[3], out[0], n);
+
+					for (usz i = 0; i < n; ++i)
+						std::memcpy(dst + i * dstStride + job.dst, &out[0][i], 4);
+				}
+		}
+	}
+
+	BufferLayout VertexQuantizer::quantize(const BufferLayout &layout, const Modes &modes, HashMap<u32, Dequantize> *dequantize) {
+
+		const usz srcStride = layout.stride(), vertices = layout.elements;
+
+		if (layout.initData.empty() || !srcStride || !vertices) {
+			oic::System::log()->error("VertexQuantizer::quantize requires a layout with initData");
+			return {};
+		}
+
+		const u8 *src = layout.initData.data();
+
+		List<QuantizeJob> jobs;
+		List<BufferAttributes::Attrib> attribs;
+
+		jobs.reserve(layout.formats.size());
+		attribs.reserve(layout.formats.size());
+
+		u32 offset{};
+
+		for (const auto &a : layout.formats) {
+
+			auto it = modes.find(a.index);
+			const VertexQuantization mode = it == modes.end() ? VertexQuantization::NONE : it->second;
+
+			const GPUFormat format = getFormat(a.format, mode);
+
+			if (format == GPUFormat::NONE) {
+				oic::System::log()->error("VertexQuantizer::quantize called with a mode that doesn't fit the attribute format");
+				return {};
+			}
+
+			QuantizeJob job{};
+			job.src = a.offset;
+			job.srcSize = u32(FormatHelper::getSizeBytes(a.format));
+			job.channels = u8(FormatHelper::getChannelCount(a.format));
+			job.mode = mode;
+			job.format = format;
+
+			if (job.src + job.srcSize > srcStride) {
+				oic::System::log()->error("VertexQuantizer::quantize called with an attribute outside of the vertex");
+				return {};
+			}
+
+			//Quantized attributes are 4 byte aligned, others keep their packing
+
+			if (mode != VertexQuantization::NONE)
+				offset = (offset + 3) & ~3u;
+
+			job.dst = offset;
+			offset += u32(FormatHelper::getSizeBytes(format));
+
+			//Bounds of the mesh
+
+			if (mode == VertexQuantization::UNORM16) {
+
+				f32 mn[4], mx[4];
+
+				for (usz c = 0; c < 4; ++c) {
+					mn[c] = std::numeric_limits<f32>::max();
+					mx[c] = std::numeric_limits<f32>::lowest();
+				}
+
+				for (usz i = 0; i < vertices; ++i)
+					for (usz c = 0; c < job.channels; ++c) {
+
+						f32 v;
+						std::memcpy(&v, src + i * srcStride + job.src + c * 4, 4);
+
+						mn[c] = std::min(mn[c], v);
+						mx[c] = std::max(mx[c], v);
+					}
+
+				Dequantize deq{};
+
+				for (usz c = 0; c < 4; ++c) {
+
+					if (c >= job.channels) {
+						deq.scale.arr[c] = 1;
+						continue;
+					}
+
+					const f32 range = mx[c] - mn[c];
+
+					job.offset[c] = deq.offset.arr[c] = mn[c];
+					job.mul[c] = range > 0 ? 65535 / range : 0;
+					deq.scale.arr[c] = range;
+				}
+
+				if (dequantize)
+					(*dequantize)[a.index] = deq;
+			}
+
+			jobs.push_back(job);
+			attribs.push_back({ job.dst, a.index, format });
+		}
+
+		BufferLayout res;
+		res.formats = BufferAttributes(layout.instanced(), attribs);
+		res.elements = u32(vertices);
+		res.initData.resize(vertices * res.stride());
+
+		u8 *dst = res.initData.data();
+		const usz dstStride = res.stride();
+
+		parallelFor((vertices + quantizeChunk - 1) / quantizeChunk, 1, [&](usz chunk) {
+
+			const usz end = std::min((chunk + 1) * quantizeChunk, vertices);
+
+			for (usz i = chunk * quantizeChunk; i < end; i += quantizeBlock) {
+
+				const usz n = std::min(quantizeBlock, end - i);
+
+				for (const QuantizeJob &job : jobs)
+					quantizeRange(job, src + i * srcStride, srcStride, dst + i * dstStride, dstStride, n);
+			}
+		});
+
+		return res;
+	}
+
+}
@@ -0,0 +1,216 @@
+#include "graphics/memory/video_texture.hpp"
+#include "graphics/command/commands.hpp"
+#include "system/log.hpp"
+#include "system/system.hpp"
+#include <cstring>
+
+namespace ignis {
+
+	//Luma and chroma weights of the matrices
+
+	static void yuvWeights(YUVMatrix matrix, f32 &kr, f32 &kb) {
+
+		switch (matrix) {
+			case YUVMatrix::BT601:	kr = .299f;		kb = .114f;		break;
+			case YUVMatrix::BT2020:	kr = .2627f;	kb = .0593f;	break;
+			default:				kr = .2126f;	kb = .0722f;	break;
+		}
+	}
+
+	//Offset and scale of luma and chroma in samples
+
+	static void yuvRange(YUVRange range, u8 bits, f32 &yOff, f32 &yScale, f32 &cOff, f32 &cScale) {
+
+		f32 shift = f32(1 << (bits - 8));
+
+		cOff = 128 * shift;
+
+		if (range == YUVRange::FULL) {
+			yOff = 0;
+			yScale = cScale = f32((1 << bits) - 1);
+		}
+
+		else {
+			yOff = 16 * shift;
+			yScale = 219 * shift;
+			cScale = 224 * shift;
+		}
+	}
+
+	void YUVConversion::toRGB(YUVMatrix matrix, YUVRange range, u8 bits, f32 (&m)[12]) {
+
+		f32 kr, kb, yOff, yScale, cOff, cScale;
+		yuvWeights(matrix, kr, kb);
+		yuvRange(range, bits, yOff, yScale, cOff, cScale);
+
+		f32 kg = 1 - kr - kb;
+
+		//Normalized texels to samples (10 bit samples are stored in the high bits)
+
+		f32 toSample = bits == 8 ? 255.f : 65535.f / 64;
+
+		f32 ya = toSample / yScale, yb = -yOff / yScale;
+		f32 ca = toSample / cScale, cb = -cOff / cScale;
+
+		//Coefficients of (y, cb, cr) per channel
+
+		const f32 k[3][3] = {
+			{ 1, 0, 2 * (1 - kr) },
+			{ 1, -2 * kb * (1 - kb) / kg, -2 * kr * (1 - kr) / kg },
+			{ 1, 2 * (1 - kb), 0 }
+		};
+
+		for (usz i = 0; i < 3; ++i) {
+			m[i * 4 + 0] = k[i][0] * ya;
+			m[i * 4 + 1] = k[i][1] * ca;
+			m[i * 4 + 2] = k[i][2] * ca;
+			m[i * 4 + 3] = k[i][0] * yb + (k[i][1] + k[i][2]) * cb;
+		}
+	}
+
+	void YUVConversion::toYUV(YUVMatrix matrix, YUVRange range, f32 (&m)[12]) {
+
+		f32 kr, kb, yOff, yScale, cOff, cScale;
+		yuvWeights(matrix, kr, kb);
+		yuvRange(range, 8, yOff, yScale, cOff, cScale);
+
+		f32 kg = 1 - kr - kb;
+
+		const f32 k[3][3] = {
+			{ kr, kg, kb },
+			{ -kr / (2 * (1 - kb)), -kg / (2 * (1 - kb)), .5f },
+			{ .5f, -kg / (2 * (1 - kr)), -kb / (2 * (1 - kr)) }
+		};
+
+		const f32 scale[3] = { yScale / 255, cScale / 255, cScale / 255 };
+		const f32 offset[3] = { yOff / 255, cOff / 255, cOff / 255 };
+
+		for (usz i = 0; i < 3; ++i) {
+			m[i * 4 + 0] = k[i][0] * scale[i];
+			m[i * 4 + 1] = k[i][1] * scale[i];
+			m[i * 4 + 2] = k[i][2] * scale[i];
+			m[i * 4 + 3] = offset[i];
+		}
+	}
+
+	//Planes
+
+	u8 VideoTexture::getPlaneCount(VideoFormat format) {
+		return format == VideoFormat::I420 ? 3 : 2;
+	}
+
+	GPUFormat VideoTexture::getPlaneFormat(VideoFormat format, u8 plane) {
+
+		switch (format) {
+			case VideoFormat::P010:	return plane ? GPUFormat::rg16 : GPUFormat::r16;
+			case VideoFormat::I420:	return GPUFormat::r8;
+			default:				return plane ? GPUFormat::rg8 : GPUFormat::r8;
+		}
+	}
+
+	Vec2u16 VideoTexture::getPlaneSize(VideoFormat, const Vec2u16 &dimensions, u8 plane) {
+		return plane ? Vec2u16(u16((dimensions.x + 1) / 2), u16((dimensions.y + 1) / 2)) : dimensions;
+	}
+
+	usz VideoTexture::getFrameBytes(VideoFormat format, const Vec2u16 &dimensions) {
+
+		usz bytes{};
+
+		for (u8 i = 0, j = getPlaneCount(format); i < j; ++i) {
+			Vec2u16 size = getPlaneSize(format, dimensions, i);
+			bytes += FormatHelper::getImageBytes(getPlaneFormat(format, i), size.x, size.y);
+		}
+
+		return bytes;
+	}
+
+	VideoTexture::VideoTexture(Graphics &g, const String &name, const Info &inf): info(inf) {
+
+		if (!info.dimensions.x || !info.dimensions.y)
+			oic::System::log()->fatal("VideoTexture created with invalid dimensions");
+
+		u8 planeCount = getPlaneCount(info.format);
+		planes.resize(planeCount);
+
+		for (u8 i = 0; i < planeCount; ++i)
+			planes[i] = TextureRef(
+				g, name + " plane " + std::to_string(i),
+				Texture::Info(
+					getPlaneSize(info.format, info.dimensions, i), getPlaneFormat(info.format, i),
+					GPUMemoryUsage::CPU_WRITE, 1, 1
+				)
+			);
+
+		output = TextureRef(
+			g, name, Texture::Info(info.dimensions, info.output, GPUMemoryUsage::GPU_WRITE_ONLY, 1, 1)
+		);
+	}
+
+	bool VideoTexture::write(const u8 *frame) {
+
+		if (!frame) {
+			oic::System::log()->error("VideoTexture::write called without a frame");
+			return false;
+		}
+
+		for (u8 i = 0, j = u8(planes.size()); i < j; ++i) {
+
+			if (!write(i, frame))
+				return false;
+
+			Vec2u16 size = getPlaneSize(info.format, info.dimensions, i);
+			frame += FormatHelper::getImageBytes(getPlaneFormat(info.format, i), size.x, size.y);
+		}
+
+		return true;
+	}
+
+	bool VideoTexture::write(u8 plane, const u8 *src, usz rowPitch, const Vec2u16 &offset, const Vec2u16 &siz) {
+
+		if (plane >= planes.size() || !src) {
+			oic::System::log()->error("VideoTexture::write called on an invalid plane");
+			return false;
+		}
+
+		Texture *tex = planes[plane];
+		Vec2u16 planeSize = tex->getInfo().dimensions.xy();
+
+		if ((offset >= planeSize).any()) {
+			oic::System::log()->error("VideoTexture::write out of bounds");
+			return false;
+		}
+
+		Vec2u16 size = siz.all() ? siz : planeSize - offset;
+
+		if (((offset + size) > planeSize).any()) {
+			oic::System::log()->error("VideoTexture::write out of bounds");
+			return false;
+		}
+
+		const usz stride = FormatHelper::getSizeBytes(tex->getInfo().format);
+		const auto &sub = tex->getInfo().getSubresource(0);
+
+		if (!rowPitch)
+			rowPitch = size.x * stride;
+
+		u8 *dst = tex->getTextureData() + offset.y * sub.rowPitch + offset.x * stride;
+
+		for (usz y = 0; y < size.y; ++y)
+			std::memcpy(dst + y * sub.rowPitch, src + y * rowPitch, size.x * stride);
+
+		tex->flush({ TextureRange{ Vec3u16(offset.x, offset.y, 0), Vec3u16(size.x, size.y, 1), 0 } });
+		return true;
+	}
+
+	void VideoTexture::addUploads(CommandList *commandList, UploadBuffer *uploadBuffer) {
+
+		for (auto &plane : planes)
+			commandList->add(cmd::FlushImage(plane, uploadBuffer));
+
+		if (planes.size() == 3)
+			commandList->add(cmd::ConvertYUV(output, planes[0], planes[1], planes[2], info.matrix, info.range, info.siting));
+
+		else commandList->add(cmd::ConvertYUV(output, planes[0], planes[1], info.matrix, info.range, info.siting));
+	}
+
+}
@@ -0,0 +1,358 @@
+#include "graphics/memory/virtual_texture.hpp"
+#include "graphics/command/commands.hpp"
+#include "utils/math.hpp"
+#include "system/log.hpp"
+#include "system/system.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <bit>
+
+namespace ignis {
+
+	static inline bool isPowerOfTwo(u32 v) { return v && !(v & (v - 1)); }
+
+	VirtualTexture::VirtualTexture(Graphics &g, const String &name, const Info &inf): info(inf) {
+
+		if (!info.loader)
+			oic::System::log()->fatal("VirtualTexture requires a tile loader");
+
+		if (!isPowerOfTwo(info.dimensions.x) || !isPowerOfTwo(info.dimensions.y) || !isPowerOfTwo(info.tileSize))
+			oic::System::log()->fatal("VirtualTexture requires power of two dimensions and tile size");
+
+		if (info.dimensions.x < info.tileSize || info.dimensions.y < info.tileSize)
+			oic::System::log()->fatal("VirtualTexture has to be at least one tile");
+
+		pages = info.dimensions / u32(info.tileSize);
+
+		if (pages.x > u16_MAX || pages.y > u16_MAX)
+			oic::System::log()->fatal("VirtualTexture has too many pages; increase the tile size");
+
+		//Every mip halves the pages until there's one left
+
+		mips = u8(std::log2(std::max(pages.x, pages.y)) + 1);
+		pageOffsets.resize(mips + 1_usz);
+
+		for (u8 m = 0; m < mips; ++m)
+			pageOffsets[m + 1_usz] = pageOffsets[m] + getPages(m).x * getPages(m).y;
+
+		pageSlots.resize(pageOffsets[mips], invalid);
+		requested.resize((pageOffsets[mips] + 31_usz) >> 5);
+
+		//Lay out the physical cache as square as possible
+
+		const u32 padded = info.tileSize + u32(info.border) * 2;
+
+		if (
+			FormatHelper::isCompressed(info.format) && (
+				padded % FormatHelper::getBlockWidth(info.format) ||
+				padded % FormatHelper::getBlockHeight(info.format)
+			)
+		)
+			oic::System::log()->fatal("VirtualTexture tiles (including border) have to be a multiple of the block size");
+
+		const u64 tileBytes = FormatHelper::getImageBytes(info.format, padded, padded);
+		const u64 tileCount = tileBytes ? info.budget / tileBytes : 0;
+
+		const u32 maxTiles = u32(u16_MAX) / padded;
+
+		u32 x = std::min(u32(std::ceil(std::sqrt(f64(tileCount)))), maxTiles);
+		u32 y = x ? u32(std::min(tileCount / x, u64(maxTiles))) : 0;
+
+		const Vec2u32 top = getPages(mips - 1);
+
+		if (x * y <= top.x * top.y)
+			oic::System::log()->fatal("VirtualTexture budget can't hold the coarsest mip and a tile");
+
+		cacheTiles = { u16(x), u16(y) };
+		slots.resize(usz(x) * y);
+
+		//Create the resources; the cache is only written through cmd::UploadImage
+
+		Texture::Info cacheInfo(
+			Vec2u16(u16(x * padded), u16(y * padded)), info.format, GPUMemoryUsage::NO_CPU_MEMORY, 1, 1
+		);
+
+		Texture::Info pageInfo(
+			Vec2u16(u16(pages.x), u16(pages.y)), GPUFormat::rgba16u, GPUMemoryUsage::CPU_WRITE, mips, 1
+		);
+
+		List<Buffer> pageData(mips);
+		dirty.resize(mips, Vec4u32(u32_MAX, u32_MAX, 0, 0));
+
+		for (u8 m = 0; m < mips; ++m)
+			pageData[m].resize(usz(getPages(m).x) * getPages(m).y * 8);
+
+		pageInfo.init(pageData);
+
+		cache = TextureRef(g, name + " cache", cacheInfo);
+		pageTable = TextureRef(g, name + " page table", pageInfo);
+
+		feedback = GPUBufferRef(g, name + " feedback", GPUBuffer::Info(
+			requested.size() * sizeof(u32), GPUBufferUsage::STORAGE, GPUMemoryUsage::GPU_WRITE
+		));
+
+		//The coarsest mip is always resident, so every page has a fallback
+
+		u32 slot{};
+
+		for (u16 j = 0; j < top.y; ++j)
+			for (u16 i = 0; i < top.x; ++i, ++slot)
+				if (!load(VirtualTile{ i, j, u8(mips - 1) }, slot))
+					oic::System::log()->fatal("VirtualTexture couldn't load the coarsest mip");
+
+		for (u32 end = u32(slots.size()); slot < end; ++slot)
+			pushFront(slot);
+
+		flushPageTable();
+	}
+
+	//Commands
+
+	void VirtualTexture::addUploads(CommandList *commandList, UploadBuffer *uploadBuffer) {
+		commandList->add(
+			cmd::FlushBuffer(feedback, uploadBuffer),
+			cmd::UploadImage(cache, uploadBuffer, &uploads),
+			cmd::FlushImage(pageTable, uploadBuffer)
+		);
+	}
+
+	void VirtualTexture::addFeedback(CommandList *commandList, UploadBuffer *uploadBuffer, TextureObject *requests) {
+
+		if (requests)
+			commandList->add(cmd::VirtualTextureFeedback(requests, feedback, pages, mips));
+
+		commandList->add(
+			cmd::ReadbackBuffer::create<VirtualTexture, &VirtualTexture::onFeedback>(feedback, uploadBuffer, this),
+			cmd::ClearBuffer(feedback)
+		);
+	}
+
+	void VirtualTexture::onFeedback(GPUBuffer*, const u8 *data, u64, u64 size) {
+
+		const u32 *bits = (const u32*) data;
+
+		for (usz i = 0, j = std::min(usz(size / sizeof(u32)), requested.size()); i < j; ++i)
+			requested[i] |= bits[i];
+	}
+
+	//Residency
+
+	VirtualTile VirtualTexture::pageTile(u32 page) const {
+
+		u8 mip = u8(std::upper_bound(pageOffsets.begin(), pageOffsets.end(), page) - pageOffsets.begin() - 1);
+
+		u32 local = page - pageOffsets[mip];
+		u32 width = getPages(mip).x;
+
+		return { u16(local % width), u16(local / width), mip };
+	}
+
+	void VirtualTexture::update() {
+
+		++frame;
+
+		List<VirtualTile> missing;
+
+		for (usz i = 0, j = requested.size(); i < j; ++i) {
+
+			u32 bits = requested[i];
+			requested[i] = 0;
+
+			for (; bits; bits &= bits - 1) {
+
+				u32 page = u32(i << 5) + u32(std::countr_zero(bits));
+
+				if (page >= pageOffsets[mips])
+					break;
+
+				u32 slot = pageSlots[page];
+
+				if (slot == invalid) {
+					missing.push_back(pageTile(page));
+					continue;
+				}
+
+				//Pinned slots aren't part of the LRU
+
+				if (slots[slot].lastUsed == u64_MAX)
+					continue;
+
+				slots[slot].lastUsed = frame;
+				unlink(slot);
+				pushFront(slot);
+			}
+		}
+
+		//Coarse tiles first; they're the fallback of the finer ones
+
+		std::sort(missing.begin(), missing.end(), [](const VirtualTile &a, const VirtualTile &b) {
+			return a.mip > b.mip;
+		});
+
+		if (missing.size() > info.uploadsPerUpdate)
+			missing.resize(info.uploadsPerUpdate);
+
+		for (auto &tile : missing) {
+
+			//Tiles needed this frame can't be evicted; the budget is exhausted
+
+			u32 slot = lruTail;
+
+			if (slot == invalid || slots[slot].lastUsed == frame)
+				break;
+
+			unlink(slot);
+
+			if (slots[slot].page != invalid) {
+
+				VirtualTile evicted = pageTile(slots[slot].page);
+
+				pageSlots[slots[slot].page] = invalid;
+				slots[slot].page = invalid;
+
+				refresh(evicted);
+			}
+
+			if (!load(tile, slot)) {
+				oic::System::log()->error("VirtualTexture couldn't load a tile");
+				pushFront(slot);
+				continue;
+			}
+
+			slots[slot].lastUsed = frame;
+			pushFront(slot);
+		}
+
+		flushPageTable();
+	}
+
+	bool VirtualTexture::load(const VirtualTile &tile, u32 slot) {
+
+		const u32 padded = info.tileSize + u32(info.border) * 2;
+		const u32 bh = FormatHelper::isCompressed(info.format) ? u32(FormatHelper::getBlockHeight(info.format)) : 1;
+
+		const Vec2u32 pos = Vec2u32(slot % cacheTiles.x, slot / cacheTiles.x) * padded;
+
+		//The tile is loaded into the upload queue; rows of texels (or blocks) are tightly packed
+
+		const usz rowPitch = FormatHelper::getImageBytes(info.format, padded, bh);
+		const usz offset = uploads.data.size();
+
+		uploads.data.resize(offset + FormatHelper::getImageBytes(info.format, padded, padded));
+
+		if (!info.loader(info.instance, tile, uploads.data.data() + offset, rowPitch)) {
+			uploads.data.resize(offset);
+			return false;
+		}
+
+		uploads.regions.push_back({
+			TextureRange{ Vec3u16(u16(pos.x), u16(pos.y), 0), Vec3u16(u16(padded), u16(padded), 1), 0 }, offset
+		});
+
+		u32 page = pageId(tile);
+
+		slots[slot].page = page;
+		slots[slot].lastUsed = tile.mip == mips - 1 ? u64_MAX : frame;
+		pageSlots[page] = slot;
+
+		refresh(tile);
+		return true;
+	}
+
+	//Point the page to its tile (if resident) or to the entry of its parent,
+	//then the finer pages that inherit it; pages with a resident tile (and the pages under them) don't change
+
+	void VirtualTexture::refresh(const VirtualTile &tile) {
+
+		const Vec2u32 size = getPages(tile.mip);
+
+		u16 *entry = (u16*) pageTable->getTextureData(tile.mip) + (usz(tile.y) * size.x + tile.x) * 4;
+		u32 slot = pageSlots[pageId(tile)];
+
+		if (slot != invalid) {
+			entry[0] = u16(slot % cacheTiles.x);
+			entry[1] = u16(slot / cacheTiles.x);
+			entry[2] = tile.mip;
+			entry[3] = 1;
+		}
+
+		//Pages are a power of two, so the parent always exists
+
+		else if (tile.mip + 1 < mips) {
+			const u32 parentWidth = getPages(u8(tile.mip + 1)).x;
+			const u16 *parent = (const u16*) pageTable->getTextureData(tile.mip + 1_usz);
+			std::memcpy(entry, parent + (usz(tile.y >> 1) * parentWidth + (tile.x >> 1)) * 4, 8);
+		}
+
+		Vec4u32 &d = dirty[tile.mip];
+		d = Vec4u32(std::min(d.x, u32(tile.x)), std::min(d.y, u32(tile.y)), std::max(d.z, tile.x + 1u), std::max(d.w, tile.y + 1u));
+
+		if (!tile.mip)
+			return;
+
+		const Vec2u32 child = getPages(u8(tile.mip - 1));
+
+		for (u32 j = tile.y * 2u, jEnd = std::min(j + 2, child.y); j < jEnd; ++j)
+			for (u32 i = tile.x * 2u, iEnd = std::min(i + 2, child.x); i < iEnd; ++i) {
+
+				VirtualTile finer{ u16(i), u16(j), u8(tile.mip - 1) };
+
+				if (pageSlots[pageId(finer)] == invalid)
+					refresh(finer);
+			}
+	}
+
+	//Upload the pages that changed since the last flush; one range per mip
+
+	void VirtualTexture::flushPageTable() {
+
+		List<TextureRange> ranges;
+
+		for (u8 m = 0; m < mips; ++m) {
+
+			Vec4u32 &d = dirty[m];
+
+			if (d.x >= d.z)
+				continue;
+
+			ranges.push_back(TextureRange{ Vec3u16(u16(d.x), u16(d.y), 0), Vec3u16(u16(d.z - d.x), u16(d.w - d.y), 1), m });
+			d = Vec4u32(u32_MAX, u32_MAX, 0, 0);
+		}
+
+		if (ranges.size())
+			pageTable->flush(ranges);
+	}
+
+	//LRU; most recently used at the head
+
+	void VirtualTexture::unlink(u32 slot) {
+
+		Slot &s = slots[slot];
+
+		if (s.prev != invalid) slots[s.prev].next = s.next;
+		else if (lruHead == slot) lruHead = s.next;
+
+		if (s.next != invalid) slots[s.next].prev = s.prev;
+		else if (lruTail == slot) lruTail = s.prev;
+
+		s.prev = s.next = invalid;
+	}
+
+	void VirtualTexture::pushFront(u32 slot) {
+
+		Slot &s = slots[slot];
+
+		s.prev = invalid;
+		s.next = lruHead;
+
+		if (lruHead != invalid)
+			slots[lruHead].prev = slot;
+
+		lruHead = slot;
+
+		if (lruTail == invalid)
+			lruTail = slot;
+	}
+
+}
@@ -0,0 +1,125 @@
+#include "graphics/parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace ignis {
+
+	struct ParallelBatch {
+
+		void (*run)(const void*, usz);
+		const void *func;
+		usz parts;
+
+		std::atomic<usz> next{};
+		usz active{};				//Workers in the batch; guarded by the pool's mutex
+
+		//Claim parts until there are none left
+		void work() {
+			for (usz t; (t = next++) < parts; )
+				run(func, t);
+		}
+	};
+
+	class ParallelPool {
+
+		List<std::thread> threads;
+		List<ParallelBatch*> batches;
+
+		std::mutex mutex;
+		std::condition_variable batchAdded, batchDone;
+
+		bool stop{};
+
+		void workerLoop() {
+
+			isPoolThread = true;
+
+			std::unique_lock<std::mutex> lock(mutex);
+
+			while (true) {
+
+				batchAdded.wait(lock, [this]() { return stop || batches.size(); });
+
+				if (stop)
+					return;
+
+				ParallelBatch *batch = batches.front();
+
+				if (batch->next >= batch->parts) {
+					batches.erase(batches.begin());
+					continue;
+				}
+
+				++batch->active;
+				lock.unlock();
+
+				batch->work();
+
+				lock.lock();
+
+				if (!--batch->active)
+					batchDone.notify_all();
+			}
+		}
+
+	public:
+
+		ParallelPool() {
+
+			usz count = std::max(usz(std::thread::hardware_concurrency()), usz(1)) - 1;
+			threads.reserve(count);
+
+			for (usz i = 0; i < count; ++i)
+				threads.push_back(std::thread(&ParallelPool::workerLoop, this));
+		}
+
+		~ParallelPool() {
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stop = true;
+			}
+
+			batchAdded.notify_all();
+
+			for (auto &thread : threads)
+				thread.join();
+		}
+
+		void run(ParallelBatch &batch) {
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				batches.push_back(&batch);
+			}
+
+			batchAdded.notify_all();
+
+			//The caller works on its own batch too, so it never waits on workers that are busy with other batches
+
+			batch.work();
+
+			//Once it's out of the queue, no worker can join the batch anymore
+
+			std::unique_lock<std::mutex> lock(mutex);
+
+			auto it = std::find(batches.begin(), batches.end(), &batch);
+
+			if (it != batches.end())
+				batches.erase(it);
+
+			batchDone.wait(lock, [&batch]() { return !batch.active; });
+		}
+	};
+
+	void parallelRun(usz parts, void (*run)(const void*, usz), const void *func) {
+
+		static ParallelPool pool;
+
+		ParallelBatch batch{ run, func, parts };
+		pool.run(batch);
+	}
+
+}